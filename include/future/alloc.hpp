@@ -0,0 +1,158 @@
+#ifndef FUT_ALLOC_HPP
+#define FUT_ALLOC_HPP
+
+#include <new>
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+#include "meta/compiler_macros.hpp"
+
+namespace fut
+{
+
+namespace det {
+
+constexpr size_t roundBlock(size_t size) noexcept {
+    return (size + 15) & ~size_t(15);
+}
+
+// Per-thread cache of free blocks of a single size class.
+// Blocks may be freed on another thread, than allocated => they migrate there
+template<size_t Size, size_t Align>
+struct FreeList {
+    struct Node {Node* next;};
+    static constexpr size_t maxCached = 1024;
+    static_assert(Size >= sizeof(Node));
+    static constexpr bool overaligned = Align > __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+    static void* raw() {
+        if constexpr (overaligned)
+            return ::operator new(Size, std::align_val_t(Align));
+        else
+            return ::operator new(Size);
+    }
+    static void rawFree(void* p) noexcept {
+        if constexpr (overaligned)
+            ::operator delete(p, std::align_val_t(Align));
+        else
+            ::operator delete(p);
+    }
+    void* Pop() {
+        if (auto n = head) {
+            head = n->next;
+            count--;
+            return n;
+        }
+        return raw();
+    }
+    void Push(void* p) noexcept {
+        if (meta_Unlikely(count == maxCached)) {
+            rawFree(p);
+            return;
+        }
+        head = new (p) Node{head};
+        count++;
+    }
+    ~FreeList() {
+        dead = true;
+        while (auto n = head) {
+            head = n->next;
+            rawFree(n);
+        }
+        count = 0;
+    }
+    Node* head = nullptr;
+    size_t count = 0;
+    // set once list is destroyed (thread exit). Trivially destructible => still readable after that
+    static inline thread_local bool dead = false;
+};
+
+template<size_t Size, size_t Align>
+FreeList<Size, Align>& freeList() noexcept {
+    static thread_local FreeList<Size, Align> list;
+    return list;
+}
+
+} //det
+
+// Fixed-size block allocator over per-thread free lists. Types with close sizes share a class.
+template<size_t Size, size_t Align = alignof(std::max_align_t)>
+struct BlockPool {
+    using List = det::FreeList<det::roundBlock(Size), Align>;
+    static void* Allocate() {
+        if (meta_Unlikely(List::dead)) return List::raw();
+        return det::freeList<det::roundBlock(Size), Align>().Pop();
+    }
+    // blocks freed by other thread-locals' destructors bypass destroyed list
+    static void Deallocate(void* p) noexcept {
+        if (meta_Unlikely(List::dead)) return List::rawFree(p);
+        det::freeList<det::roundBlock(Size), Align>().Push(p);
+    }
+};
+
+// Bump allocator for request-scoped future chains. Deallocation is a no-op,
+// all memory is returned at once when the Arena dies => it must outlive everything allocated from it.
+// Allocation is not thread-safe, objects may be destroyed on any thread.
+struct Arena {
+    explicit Arena(size_t chunkSize = 4096) noexcept : chunkSize(chunkSize) {}
+    Arena(const Arena&) = delete;
+    void* Allocate(size_t size, size_t align) {
+        auto pos = alignedPos(align);
+        if (meta_Unlikely(!chunk || pos + size > capacity)) {
+            newChunk(size + align);
+            pos = alignedPos(align);
+        }
+        used = pos + size;
+        return reinterpret_cast<char*>(chunk) + pos;
+    }
+    // arena, that new future states on this thread are allocated from (if any)
+    static Arena* Current() noexcept {
+        return current;
+    }
+    ~Arena() {
+        while (chunk) {
+            auto prev = chunk->prev;
+            ::operator delete(chunk);
+            chunk = prev;
+        }
+    }
+private:
+    friend struct ArenaScope;
+    struct Chunk {
+        Chunk* prev;
+    };
+    // chunk itself is only aligned for operator new => align real address
+    size_t alignedPos(size_t align) const noexcept {
+        auto base = reinterpret_cast<uintptr_t>(chunk);
+        return ((base + used + align - 1) & ~uintptr_t(align - 1)) - base;
+    }
+    // room for header + worst case padding
+    void newChunk(size_t atLeast) {
+        auto size = atLeast + sizeof(Chunk) > chunkSize ? atLeast + sizeof(Chunk) : chunkSize;
+        chunk = new (::operator new(size)) Chunk{chunk};
+        capacity = size;
+        used = sizeof(Chunk);
+    }
+    static inline thread_local Arena* current = nullptr;
+    size_t chunkSize;
+    Chunk* chunk = nullptr;
+    size_t used = 0;
+    size_t capacity = 0;
+};
+
+// While alive: Promise<T>() on this thread allocates states from arena
+struct [[nodiscard]] ArenaScope {
+    explicit ArenaScope(Arena& arena) noexcept : prev(Arena::current) {
+        Arena::current = &arena;
+    }
+    ArenaScope(const ArenaScope&) = delete;
+    ~ArenaScope() {
+        Arena::current = prev;
+    }
+private:
+    Arena* prev;
+};
+
+} //fut
+
+#endif //FUT_ALLOC_HPP
@@ -0,0 +1,132 @@
+#ifndef FUT_CANCEL_HPP
+#define FUT_CANCEL_HPP
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <utility>
+#include "move_func.hpp"
+
+namespace fut
+{
+
+namespace det {
+
+struct CancelState {
+    void Ref() noexcept {
+        refs.fetch_add(1, std::memory_order_relaxed);
+    }
+    void Unref() noexcept {
+        if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete this;
+        }
+    }
+    bool Cancel() {
+        if (cancelled.exchange(true, std::memory_order_acq_rel)) {
+            return false;
+        }
+        decltype(callbacks) toCall;
+        {
+            std::lock_guard lock(mut);
+            toCall.swap(callbacks);
+        }
+        for (auto& [_, cb]: toCall) {
+            cb();
+        }
+        return true;
+    }
+    size_t Subscribe(MoveFunc<void()> cb) {
+        {
+            std::lock_guard lock(mut);
+            if (!cancelled.load(std::memory_order_acquire)) {
+                callbacks.emplace_back(++lastId, std::move(cb));
+                return lastId;
+            }
+        }
+        cb();
+        return 0;
+    }
+    void Unsubscribe(size_t id) {
+        std::lock_guard lock(mut);
+        for (auto it = callbacks.begin(); it != callbacks.end(); ++it) {
+            if (it->first == id) {
+                callbacks.erase(it);
+                return;
+            }
+        }
+    }
+    std::atomic<int> refs = 1;
+    std::atomic<bool> cancelled = false;
+    std::mutex mut;
+    size_t lastId = 0;
+    std::vector<std::pair<size_t, MoveFunc<void()>>> callbacks;
+};
+
+} //det
+
+// Observer side of CancellationSource. Default-constructed token is never cancelled
+struct CancellationToken {
+    CancellationToken() noexcept = default;
+    CancellationToken(const CancellationToken& o) noexcept : st(o.st) {
+        if (st) st->Ref();
+    }
+    CancellationToken(CancellationToken&& o) noexcept : st(std::exchange(o.st, nullptr)) {}
+    CancellationToken& operator=(CancellationToken o) noexcept {
+        std::swap(st, o.st);
+        return *this;
+    }
+    bool IsCancelled() const noexcept {
+        return st && st->cancelled.load(std::memory_order_acquire);
+    }
+    bool CanBeCancelled() const noexcept {
+        return st;
+    }
+    // cb is called once on cancel (right away if already cancelled).
+    // Returns id for Unsubscribe() (0 if cb was already called or token is empty)
+    size_t Subscribe(MoveFunc<void()> cb) const {
+        return st ? st->Subscribe(std::move(cb)) : 0;
+    }
+    // does not wait for a callback, that is running concurrently
+    void Unsubscribe(size_t id) const {
+        if (st && id) st->Unsubscribe(id);
+    }
+    ~CancellationToken() {
+        if (st) st->Unref();
+    }
+private:
+    friend struct CancellationSource;
+    explicit CancellationToken(det::CancelState* st) noexcept : st(st) {
+        st->Ref();
+    }
+    det::CancelState* st = nullptr;
+};
+
+struct CancellationSource {
+    CancellationSource() : st(new det::CancelState) {}
+    CancellationSource(const CancellationSource& o) noexcept : st(o.st) {
+        st->Ref();
+    }
+    CancellationSource& operator=(CancellationSource o) noexcept {
+        std::swap(st, o.st);
+        return *this;
+    }
+    CancellationToken Token() const noexcept {
+        return CancellationToken(st);
+    }
+    // runs subscribers on calling thread, returns false if already cancelled
+    bool Cancel() const {
+        return st->Cancel();
+    }
+    bool IsCancelled() const noexcept {
+        return st->cancelled.load(std::memory_order_acquire);
+    }
+    ~CancellationSource() {
+        st->Unref();
+    }
+private:
+    det::CancelState* st;
+};
+
+} //fut
+
+#endif //FUT_CANCEL_HPP
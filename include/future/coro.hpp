@@ -0,0 +1,140 @@
+#ifndef FUT_CORO_HPP
+#define FUT_CORO_HPP
+
+#include "future.hpp"
+
+#if !defined(__cpp_impl_coroutine) || !__has_include(<coroutine>)
+#error "future/coro.hpp requires C++20 coroutines"
+#endif
+
+#include <coroutine>
+
+namespace fut
+{
+
+namespace det {
+
+// Armed by a finishing coroutine while it publishes its result: an awaiter woken
+// by that publish parks its handle here instead of resuming on top of the stack
+inline thread_local std::coroutine_handle<>* coroTransfer = nullptr;
+
+inline void resumeOrTransfer(std::coroutine_handle<> h) {
+    if (coroTransfer && !*coroTransfer) {
+        *coroTransfer = h;
+    } else {
+        h.resume();
+    }
+}
+
+template<typename T>
+struct CoroPromiseBase {
+    // the shared state is the result slot: no extra Promise per co_await/co_return
+    FutureState<T> state = FutureStateData<T>::Make();
+
+    Future<T> get_return_object() {
+        state->AddOnce(FutureStateData<T>::future_taken);
+        return Future<T>(state);
+    }
+    std::suspend_never initial_suspend() noexcept {
+        return {};
+    }
+    void unhandled_exception() noexcept {
+        state->Store({std::current_exception()});
+    }
+    struct FinalAwaiter {
+        bool await_ready() noexcept {
+            return false;
+        }
+        template<typename P>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) noexcept {
+            // frame is not needed anymore => destroy before waking awaiter
+            auto st = std::move(h.promise().state);
+            h.destroy();
+            std::coroutine_handle<> next;
+            auto prev = std::exchange(coroTransfer, &next);
+            st->Publish();
+            coroTransfer = prev;
+            if (next) return next;
+            return std::noop_coroutine();
+        }
+        void await_resume() noexcept {}
+    };
+    FinalAwaiter final_suspend() noexcept {
+        return {};
+    }
+};
+
+template<typename T>
+struct CoroPromise : CoroPromiseBase<T> {
+    template<typename U = T>
+    void return_value(U&& value) {
+        T v(std::forward<U>(value));
+        this->state->Store({&v});
+    }
+};
+
+template<>
+struct CoroPromise<void> : CoroPromiseBase<void> {
+    void return_void() {
+        this->state->Store({reinterpret_cast<void*>(1)});
+    }
+};
+
+template<typename T>
+struct FutureAwaiter {
+    explicit FutureAwaiter(Future<T> fut) noexcept : fut(std::move(fut)) {}
+    Future<T> fut;
+    ResultSlot<T> result;
+    std::coroutine_handle<> waiter;
+    std::atomic<bool> ready = false;
+
+    // ready future => no suspension at all
+    bool await_ready() noexcept {
+        if (!fut.IsReady()) {
+            return false;
+        }
+        fut.Then([this](FutureResult<T> res) noexcept {
+            result.Set(std::move(res));
+        });
+        return true;
+    }
+    bool await_suspend(std::coroutine_handle<> h) noexcept {
+        waiter = h;
+        fut.Then([this](FutureResult<T> res) noexcept {
+            result.Set(std::move(res));
+            // second one to arrive wakes coroutine (or it did not suspend at all)
+            if (ready.exchange(true, std::memory_order_acq_rel)) {
+                resumeOrTransfer(waiter);
+            }
+        });
+        return !ready.exchange(true, std::memory_order_acq_rel);
+    }
+    T await_resume() {
+        auto res = result.Get();
+        if (!res) res.Rethrow();
+        if constexpr (!std::is_void_v<T>) {
+            return std::move(*res.Result());
+        }
+    }
+};
+
+} //det
+
+// consumes future (same as Then())
+template<typename T>
+det::FutureAwaiter<T> operator co_await(Future<T>&& fut) noexcept {
+    return det::FutureAwaiter<T>(std::move(fut));
+}
+
+// awaiting consumes future => lvalue must be moved explicitly: co_await std::move(fut)
+template<typename T>
+void operator co_await(Future<T>& fut) = delete;
+
+} //fut
+
+template<typename T, typename...Args>
+struct std::coroutine_traits<fut::Future<T>, Args...> {
+    using promise_type = fut::det::CoroPromise<T>;
+};
+
+#endif //FUT_CORO_HPP
@@ -0,0 +1,62 @@
+#ifndef FUT_EXECUTOR_HPP
+#define FUT_EXECUTOR_HPP
+
+#include <deque>
+#include <mutex>
+#include "move_func.hpp"
+
+namespace fut
+{
+
+using Task = MoveFunc<void()>;
+
+// Anything with Execute(Task) can be passed to Future::Via()/Then(ex, cb),
+// this base is only needed when executors are stored type-erased.
+// Thread pool lives in thread_pool.hpp
+struct Executor {
+    virtual void Execute(Task task) = 0;
+    virtual ~Executor() = default;
+};
+
+// runs task right away on the calling thread
+struct InlineExecutor final : Executor {
+    void Execute(Task task) override {
+        task();
+    }
+};
+
+// queues tasks until the owner drains them (event loops, deterministic tests)
+struct ManualExecutor final : Executor {
+    void Execute(Task task) override {
+        std::lock_guard lock(mut);
+        queue.push_back(std::move(task));
+    }
+    bool RunOne() {
+        Task task;
+        {
+            std::lock_guard lock(mut);
+            if (queue.empty()) return false;
+            task = std::move(queue.front());
+            queue.pop_front();
+        }
+        task();
+        return true;
+    }
+    // also runs tasks, that were queued while draining
+    size_t Drain() {
+        size_t count = 0;
+        while (RunOne()) count++;
+        return count;
+    }
+    size_t Pending() const {
+        std::lock_guard lock(mut);
+        return queue.size();
+    }
+private:
+    mutable std::mutex mut;
+    std::deque<Task> queue;
+};
+
+} //fut
+
+#endif //FUT_EXECUTOR_HPP
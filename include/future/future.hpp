@@ -3,7 +3,11 @@
 
 #include <cassert>
 #include <atomic>
+#include <optional>
+#include <cstdint>
 #include "move_func.hpp"
+#include "alloc.hpp"
+#include "cancel.hpp"
 
 #define MV(x) x=std::move(x)
 
@@ -34,9 +38,6 @@ template<typename T> struct FutureResult;
 namespace det {
 template<typename U>
 using if_exception = std::enable_if_t<std::is_base_of_v<std::exception, std::decay_t<U>>, int>;
-template<typename U> struct _is_small :
-                   std::bool_constant<sizeof(U) <= sizeof(U*) && std::is_trivial_v<U>> {};
-template<> struct _is_small<void> : std::true_type {};
 inline constexpr std::true_type defGuard() noexcept {return {};}
 }
 
@@ -74,67 +75,288 @@ private:
     T* res = {};
 };
 
+namespace det {
+// value or exception, stored inline (no extra allocation for non-trivial T)
+template<typename T> struct ResultSlot {
+    using value_type = non_void_t<T>;
+    ResultSlot() noexcept {}
+    ResultSlot(const ResultSlot&) = delete;
+    ResultSlot(ResultSlot&& o) noexcept {
+        moveFrom(o);
+    }
+    ResultSlot& operator=(ResultSlot&& o) noexcept {
+        if (this != &o) {
+            Reset();
+            moveFrom(o);
+        }
+        return *this;
+    }
+    template<typename...Args>
+    void Emplace(Args&&...a) {
+        new (&value) value_type{std::forward<Args>(a)...};
+        kind = has_value;
+    }
+    void SetError(std::exception_ptr exc) noexcept {
+        new (&error) std::exception_ptr(std::move(exc));
+        kind = has_error;
+    }
+    void Set(FutureResult<T> res) {
+        if (auto r = res.Result()) {
+            if constexpr (std::is_void_v<T>)
+                Emplace();
+            else
+                Emplace(std::move(*r));
+        } else {
+            SetError(res.MoveException());
+        }
+    }
+    FutureResult<T> Get() noexcept {
+        if (kind == has_error) return {error};
+        else return {static_cast<T*>(static_cast<void*>(&value))};
+    }
+    bool Empty() const noexcept {
+        return kind == empty_slot;
+    }
+    void Reset() noexcept {
+        if (kind == has_value) value.~value_type();
+        else if (kind == has_error) error.~exception_ptr();
+        kind = empty_slot;
+    }
+    ~ResultSlot() {
+        Reset();
+    }
+private:
+    void moveFrom(ResultSlot& o) noexcept {
+        if (o.kind == has_value) new (&value) value_type(std::move(o.value));
+        else if (o.kind == has_error) new (&error) std::exception_ptr(std::move(o.error));
+        kind = o.kind;
+        o.Reset();
+    }
+    union {
+        value_type value;
+        std::exception_ptr error;
+    };
+    enum : unsigned char {empty_slot, has_value, has_error} kind = empty_slot;
+};
+// subscription of Future::CancelOn(), dropped once state is resolved
+struct CancelSub {
+    CancellationToken token;
+    size_t id;
+    CancelSub* next;
+};
+inline CancelSub* closedSubs() noexcept {
+    return reinterpret_cast<CancelSub*>(uintptr_t(1));
+}
+}
+
+// Inline room for continuations: Then() wraps user callback together with
+// chained Promise => typical lambda (up to 5 pointers of captures) does not spill
+static constexpr auto CALLBACK_SOO = sizeof(void*) * 6;
+
 template<typename T> struct FutureStateData {
-    static constexpr bool is_small = det::_is_small<T>::value;
+    using Callback = MoveFunc<void(FutureResult<T>), CALLBACK_SOO>;
     FutureStateData() noexcept {}
     FutureStateData(const FutureStateData&) = delete;
-    enum StateFlags {
+    ~FutureStateData() {
+        dropCancelSubs();
+    }
+    enum StateFlags : unsigned {
         resolved = 1,
-        future_taken = 2
+        future_taken = 2,
+        has_callback = 4,
+        from_arena = 8,
+        cancel_requested = 16,
+        has_cancel_hook = 32,
+        has_cancel_source = 64,
     };
+    // allocates from current Arena (if any) or from per-thread pool
+    static FutureStateData* Make() {
+        if (auto arena = Arena::Current()) {
+            auto place = arena->Allocate(sizeof(FutureStateData), alignof(FutureStateData));
+            return new (place) FutureStateData(from_arena);
+        }
+        return new FutureStateData;
+    }
+    static void* operator new(size_t) {
+        return BlockPool<sizeof(FutureStateData), alignof(FutureStateData)>::Allocate();
+    }
+    static void* operator new(size_t, void* place) noexcept {
+        return place;
+    }
+    static void operator delete(void* p) noexcept {
+        BlockPool<sizeof(FutureStateData), alignof(FutureStateData)>::Deallocate(p);
+    }
     MoveFunc<bool()> Guard = {det::defGuard};
-    void SetCallback(MoveFunc<void(FutureResult<T>)> cb) noexcept {
-        if (Flags & resolved) {
-            if (!Guard()) return;
-            if (error) cb({std::move(error)});
-            else if constexpr (is_small) cb({reinterpret_cast<T*>(&result)});
-            else cb({result});
-        } else {
-            callback = std::move(cb);
+    // Resolve() and SetCallback() may race from different threads:
+    // each side publishes its part with a single RMW on Flags and
+    // the one that observes the other's bit runs the callback
+    void SetCallback(Callback cb) noexcept {
+        if (Has(resolved)) {
+            if (Guard()) std::move(cb)(storedResult());
+            return;
+        }
+        callback = std::move(cb);
+        if (AddOnce(has_callback) & resolved) {
+            runCallback(storedResult());
         }
     }
-    void AddOnce(StateFlags flag) {
-        if (Flags & flag) {
+    unsigned AddOnce(StateFlags flag) noexcept {
+        auto was = Flags.fetch_or(flag, std::memory_order_acq_rel);
+        if (meta_Unlikely(was & flag)) {
             assert(!bool("invalid promise (double resolve or GetFuture())"));
             std::abort();
         }
-        Flags |= flag;
+        return was;
+    }
+    bool Has(StateFlags flag) const noexcept {
+        return Flags.load(std::memory_order_acquire) & flag;
+    }
+    // snapshot of StateFlags (Flags itself is atomic and written only through Resolve() & co.)
+    unsigned GetFlags() const noexcept {
+        return Flags.load(std::memory_order_acquire);
+    }
+    bool IsResolved() const noexcept {
+        return Has(resolved);
     }
     void Resolve(FutureResult<T> res) noexcept {
-        AddOnce(resolved);
-        Flags |= resolved;
-        if (callback) {
-            if (Guard()) callback(std::move(res));
-        } else if (auto r = res.Result()) {
-            if constexpr (std::is_void_v<T>)
-                result = r;
-            else if constexpr (is_small)
-                new (&result) T{std::move(*r)};
-            else
-                result = new T{std::move(*r)};
-        } else {
-            error = res.MoveException();
+        if (Has(has_callback)) {
+            // callback is already published => pass result directly
+            dropCancelHook(AddOnce(resolved));
+            runCallback(std::move(res));
+            return;
+        }
+        Store(std::move(res));
+        Publish();
+    }
+    // two-phase Resolve(): Store() fills the result slot, Publish() marks
+    // state resolved and runs callback if it was set in between
+    void Store(FutureResult<T> res) noexcept {
+        result.Set(std::move(res));
+    }
+    void Publish() noexcept {
+        auto was = AddOnce(resolved);
+        dropCancelHook(was);
+        if (was & has_callback) {
+            runCallback(storedResult());
+        }
+    }
+    // consumer side: ask producer to stop early, hooks run once (now or when set)
+    void Cancel() noexcept {
+        auto was = Flags.fetch_or(cancel_requested, std::memory_order_acq_rel);
+        if (was & (cancel_requested | resolved)) {
+            return;
+        }
+        if (was & has_cancel_hook) {
+            runCancelHook();
+        }
+        if (was & has_cancel_source) {
+            cancelSource->Cancel();
+        }
+    }
+    // producer side, hooks are dropped without a call once state is resolved.
+    // First hook is stored inline, further ones subscribe to CancelToken()
+    void OnCancel(MoveFunc<void()> hook) noexcept {
+        auto flags = Flags.load(std::memory_order_acquire);
+        if (flags & resolved) {
+            return;
+        } else if (flags & cancel_requested) {
+            hook();
+            return;
+        } else if (flags & has_cancel_hook) {
+            CancelToken().Subscribe(std::move(hook));
+            return;
+        }
+        cancelHook = std::move(hook);
+        auto was = AddOnce(has_cancel_hook);
+        if (was & resolved) {
+            cancelHook = {};
+        } else if (was & cancel_requested) {
+            runCancelHook();
+        }
+    }
+    // consumer side: Cancel() once token is cancelled (lock-free push, closed on resolve)
+    void CancelOn(const CancellationToken& token) {
+        if (Has(resolved) || !token.CanBeCancelled()) {
+            return;
+        }
+        auto sub = new det::CancelSub{token, 0, nullptr};
+        sub->id = token.Subscribe([st = FutureState<T>(this)]{st->Cancel();});
+        if (!sub->id) {
+            delete sub;
+            return;
+        }
+        auto head = cancelSubs.load(std::memory_order_acquire);
+        do {
+            if (head == det::closedSubs()) {
+                sub->token.Unsubscribe(sub->id);
+                delete sub;
+                return;
+            }
+            sub->next = head;
+        } while (!cancelSubs.compare_exchange_weak(head, sub, std::memory_order_acq_rel, std::memory_order_acquire));
+    }
+    // producer side: token cancelled together with this state, created once on first call.
+    // Empty (never cancelled) token once state is resolved
+    CancellationToken CancelToken() {
+        auto flags = Flags.load(std::memory_order_acquire);
+        if (flags & resolved) {
+            return {};
+        }
+        if (!(flags & has_cancel_source)) {
+            cancelSource.emplace();
+            if (AddOnce(has_cancel_source) & cancel_requested) {
+                cancelSource->Cancel();
+            }
         }
+        return cancelSource->Token();
     }
     void Unref() noexcept {
         if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
-            delete this;
+            if (Has(from_arena)) this->~FutureStateData();
+            else delete this;
         }
     }
     void AddRef() noexcept {
-        refs.fetch_add(1, std::memory_order_acq_rel);
+        refs.fetch_add(1, std::memory_order_relaxed);
     }
-    ~FutureStateData() {
-        if constexpr(!is_small) {
-            if (result) {delete result;}
+protected:
+    explicit FutureStateData(unsigned flags) noexcept : Flags(flags) {}
+    FutureResult<T> storedResult() noexcept {
+        return result.Get();
+    }
+    void runCancelHook() noexcept {
+        auto hook = std::move(cancelHook);
+        hook();
+    }
+    // subscriptions hold this state => released on resolve (or with state, if token fired)
+    void dropCancelSubs() noexcept {
+        auto sub = cancelSubs.exchange(det::closedSubs(), std::memory_order_acq_rel);
+        while (sub && sub != det::closedSubs()) {
+            sub->token.Unsubscribe(sub->id);
+            delete std::exchange(sub, sub->next);
         }
     }
-    std::underlying_type_t<StateFlags> Flags = {};
-protected:
-    std::exception_ptr error = {};
+    // hook may hold upstream state (see Then()) => release it as soon as it is not needed
+    void dropCancelHook(unsigned was) noexcept {
+        dropCancelSubs();
+        if (!(was & cancel_requested)) {
+            if (was & has_cancel_hook) cancelHook = {};
+            if (was & has_cancel_source) cancelSource.reset();
+        }
+    }
+    // rejected callback is released right away: it may hold chained Promise,
+    // that holds this state through its cancel hook (see linkCancel())
+    void runCallback(FutureResult<T> res) noexcept {
+        if (Guard()) callback(std::move(res));
+        else callback = {};
+    }
+    std::atomic<unsigned> Flags = {};
     std::atomic<int> refs = 0;
-    MoveFunc<void(FutureResult<T>)> callback {};
-    T* result = {}; //maybe an erased small value => use Get/SetResult()
+    Callback callback {};
+    MoveFunc<void()> cancelHook {};
+    std::optional<CancellationSource> cancelSource;
+    std::atomic<det::CancelSub*> cancelSubs = nullptr;
+    det::ResultSlot<T> result;
 };
 
 template<typename T>
@@ -172,6 +394,9 @@ struct FutureState {
     }
 };
 
+// Either shared state (filled by Promise) or ready result held inline:
+// FutureFromResult() & co. do not allocate, Then() on a ready future runs
+// callback right away and returns ready future as well
 template<typename T>
 struct [[nodiscard]] Future
 {
@@ -179,17 +404,42 @@ public:
     using value_type = T;
     Future() = default;
     Future(Future const&) = delete;
-    Future(Future&& o) noexcept : state(std::exchange(o.state, nullptr)) {}
+    Future(Future&& o) noexcept :
+        state(std::exchange(o.state, nullptr)), ready(std::move(o.ready))
+    {}
     Future& operator=(Future&& o) noexcept {
         std::swap(state, o.state);
+        ready = std::move(o.ready);
         return *this;
     }
-    bool IsValid() const noexcept {return state;}
+    // ready future, see FutureFromResult()
+    explicit Future(FutureResult<T> res) {
+        ready.Set(std::move(res));
+    }
+    bool IsValid() const noexcept {return state || !ready.Empty();}
+    // result is available => Then() callback runs synchronously
+    bool IsReady() const noexcept {
+        return !ready.Empty() || (state && state->Has(FutureStateData<T>::resolved));
+    }
     template<typename Cb>
     auto Then(Cb cb) noexcept;
+    // continue on executor (any type with Execute(MoveFunc<void()>))
+    template<typename Ex>
+    Future Via(Ex& executor) noexcept;
+    template<typename Ex, typename Cb>
+    auto Then(Ex& executor, Cb cb) noexcept {
+        return Via(executor).Then(std::move(cb));
+    }
     template<typename Guard, typename Cb>
     auto ThenIf(Guard g, Cb cb) noexcept {
         checkState();
+        if (!ready.Empty()) {
+            if (g()) return this->Then(std::move(cb));
+            // rare: keep semantics of dropped callback (chained future gets TimeoutError)
+            toState();
+            state.data->Guard = []{return false;};
+            return this->Then(std::move(cb));
+        }
         state.data->Guard = std::move(g);
         return this->Then(std::move(cb));
     }
@@ -204,32 +454,55 @@ public:
             }
         });
     }
+    // request producer to stop (see Promise::OnCancel()), future stays valid.
+    // Futures returned from Then()/Via() forward this upstream
+    void Cancel() noexcept {
+        if (state) state->Cancel();
+    }
+    // Cancel() when token is cancelled. Unsubscribed once this future is resolved
+    void CancelOn(const CancellationToken& token) {
+        checkState();
+        if (state) state->CancelOn(token);
+    }
+    // ready future is moved into a new shared state
     FutureState<T> TakeState() {
+        if (!ready.Empty()) toState();
         return std::exchange(state, FutureState<T>{});
     }
+    // nullptr for ready future (nothing to cancel or wait for)
     FutureStateData<T>* PeekState() {
         return state.data;
     }
     Future(FutureState<T> state) noexcept : state(state) {}
 protected:
+    template<typename U>
+    void linkCancel(const Promise<U>& chain) {
+        chain.OnCancel([up = state]{up->Cancel();});
+    }
     void checkState() {
-        if (meta_Unlikely(!state)) {
+        if (meta_Unlikely(!IsValid())) {
             assert("invalid future resolved");
             throw std::runtime_error("invalid future resolved");
         }
     }
+    void toState() {
+        state = FutureStateData<T>::Make();
+        state->Resolve(ready.Get());
+        ready.Reset();
+    }
     FutureState<T> state = {};
+    det::ResultSlot<T> ready;
 };
 
 template<typename Der, typename T> struct PromiseBase {
     void Resolve(T value) const noexcept {
-        static_cast<const Der&>(*this).Resolve({&value});
+        static_cast<const Der&>(*this).Resolve(FutureResult<T>{&value});
     }
 };
 
 template<typename Der> struct PromiseBase<Der, void> {
     void Resolve() const noexcept {
-        static_cast<const Der&>(*this).Resolve({reinterpret_cast<void*>(1)});
+        static_cast<const Der&>(*this).Resolve(FutureResult<void>{reinterpret_cast<void*>(1)});
     }
 };
 
@@ -237,7 +510,7 @@ template<typename T>
 struct Promise : PromiseBase<Promise<T>, T> {
     using value_type = T;
     using PromiseBase<Promise<T>, T>::Resolve;
-    Promise() : Promise(FutureState<T>{new FutureStateData<T>}) {}
+    Promise() : Promise(FutureState<T>{FutureStateData<T>::Make()}) {}
     Promise(FutureState<T> state_) noexcept : state(std::move(state_)) {}
     Promise(Promise &&o) noexcept :
         state{std::exchange(o.state, nullptr)}
@@ -270,14 +543,28 @@ struct Promise : PromiseBase<Promise<T>, T> {
         Resolve(std::make_exception_ptr(std::forward<U>(exc)));
     }
     bool IsValid() const noexcept {
-        return state && !(state->Flags & FutureStateData<T>::resolved);
+        return state && !state->Has(FutureStateData<T>::resolved);
+    }
+    // hook is called once if consumer calls Future::Cancel() before resolve (any number of hooks)
+    template<typename Fn>
+    void OnCancel(Fn hook) const noexcept {
+        checkValid();
+        state->OnCancel(std::move(hook));
+    }
+    bool IsCancelled() const noexcept {
+        return state && state->Has(FutureStateData<T>::cancel_requested);
+    }
+    // token, that is cancelled with this promise (same source on repeated calls)
+    CancellationToken Token() const {
+        checkValid();
+        return state->CancelToken();
     }
     template<typename U>
     void operator()(U&& v) const noexcept {
         this->Resolve(std::forward<U>(v));
     }
     ~Promise() {
-        auto hasFut = IsValid() && (state->Flags & FutureStateData<T>::future_taken);
+        auto hasFut = IsValid() && state->Has(FutureStateData<T>::future_taken);
         if (meta_Unlikely(hasFut)) {
             Resolve(TimeoutError{});
         }
@@ -314,22 +601,16 @@ std::future<T> ToStdFuture(Future<T>&& fut) {
 
 template<typename T>
 Future<T> FutureFromResult(T value) {
-    auto state = new FutureStateData<T>();
-    state->Resolve(&value);
-    return Future<T>(state);
+    return Future<T>(FutureResult<T>{&value});
 }
 
 inline Future<void> FutureFromVoid() {
-    auto state = new FutureStateData<void>();
-    state->Resolve(reinterpret_cast<void*>(1));
-    return Future<void>(state);
+    return Future<void>(FutureResult<void>{reinterpret_cast<void*>(1)});
 }
 
 template<typename T>
 Future<T> FutureFromException(std::exception_ptr exc) {
-    auto state = new FutureStateData<T>();
-    state->Resolve(std::move(exc));
-    return Future<T>(state);
+    return Future<T>(FutureResult<T>{std::move(exc)});
 }
 
 template<typename T, typename Exc>
@@ -340,81 +621,142 @@ Future<T> FutureFromException(Exc&& exc) {
 namespace det {
 template<typename T> struct strip_fut {using type = T;};
 template<typename T> struct strip_fut<Future<T>> {using type = T;};
+
+template<typename T, typename Cb>
+constexpr auto thenRet() noexcept {
+    if constexpr (std::is_invocable_v<Cb, FutureResult<T>>) {
+        return TypeList<std::invoke_result_t<Cb, FutureResult<T>>>{};
+    } else if constexpr (!std::is_void_v<T> && std::is_invocable_v<Cb, T>) {
+        return TypeList<std::invoke_result_t<Cb, T>>{};
+    } else if constexpr (std::is_void_v<T> && std::is_invocable_v<Cb>) {
+        return TypeList<std::invoke_result_t<Cb>>{};
+    } else {
+        static_assert(always_false<Cb>, "Invalid callback => must accept Result<T> or T");
+    }
+}
+template<typename T, typename Cb>
+using then_ret_t = HeadTypeOf_t<decltype(thenRet<T, Cb>())>;
+
+// Promise-like target for Then() on a ready future: result goes straight into a ready Future
+template<typename R>
+struct ReadySink : PromiseBase<ReadySink<R>, R> {
+    using PromiseBase<ReadySink<R>, R>::Resolve;
+    explicit ReadySink(Future<R>& out) noexcept : out(&out) {}
+    void Resolve(FutureResult<R> res) const noexcept {
+        *out = Future<R>(std::move(res));
+    }
+    void Resolve(std::exception_ptr exc) const noexcept {
+        Resolve(FutureResult<R>{std::move(exc)});
+    }
+    Future<R>* out;
+};
+
+template<typename R>
+void chainTo(Future<R>&& fut, Promise<R>& chain) noexcept {
+    fut.Then(std::move(chain));
+}
+
+template<typename R>
+void chainTo(Future<R>&& fut, ReadySink<R>& sink) noexcept {
+    *sink.out = std::move(fut);
+}
+
+// body of Then() continuation, chain is Promise or ReadySink
+template<typename T, typename Cb, typename Chain>
+void runThen(Cb& cb, FutureResult<T> res, Chain& chain) noexcept {
+    using rawResT = then_ret_t<T, Cb>;
+    try {
+        if constexpr (std::is_invocable_v<Cb, FutureResult<T>>) {
+            if constexpr (is_future<rawResT>::value) {
+                chainTo(cb(std::move(res)), chain);
+            } else {
+                chain.Resolve(cb(std::move(res)));
+            }
+        } else {
+            if (!res) {
+                chain.Resolve(res.MoveException());
+                return;
+            }
+            auto call = [&]() -> rawResT {
+                if constexpr (std::is_void_v<T>) return cb();
+                else return cb(std::move(*res.Result()));
+            };
+            if constexpr (std::is_void_v<rawResT>) {
+                call(); chain.Resolve();
+            } else if constexpr (is_future<rawResT>::value) {
+                chainTo(call(), chain);
+            } else {
+                chain.Resolve(call());
+            }
+        }
+    } catch (...) {chain.Resolve(std::current_exception());}
+}
+}
+
+template<typename T>
+template<typename Ex>
+Future<T> Future<T>::Via(Ex& executor) noexcept {
+    checkState();
+    Promise<T> chain;
+    auto fut = chain.GetFuture();
+    auto post = [ex = &executor](Promise<T>& chain, FutureResult<T> res) noexcept {
+        if (!res) {
+            ex->Execute([MV(chain), exc = res.MoveException()]() mutable noexcept {
+                chain.Resolve(std::move(exc));
+            });
+        } else if constexpr (std::is_void_v<T>) {
+            ex->Execute([MV(chain)]() mutable noexcept {
+                chain.Resolve();
+            });
+        } else {
+            ex->Execute([MV(chain), value = std::move(*res.Result())]() mutable noexcept {
+                chain.Resolve(std::move(value));
+            });
+        }
+    };
+    if (!ready.Empty()) {
+        post(chain, ready.Get());
+        ready.Reset();
+        return fut;
+    }
+    linkCancel(chain);
+    this->state->SetCallback([MV(post), MV(chain)](FutureResult<T> res) mutable noexcept {
+        post(chain, std::move(res));
+    });
+    state = {};
+    return fut;
 }
 
 template<typename T>
 template<typename Cb>
 auto Future<T>::Then(Cb cb) noexcept {
     checkState();
-    // todo: maybe more optimal forward for promises
-    if constexpr (std::is_invocable_v<Cb, FutureResult<T>>) {
-        using rawResT = std::invoke_result_t<Cb, FutureResult<T>>;
-        using resT = typename det::strip_fut<rawResT>::type;
-        if constexpr (std::is_void_v<rawResT>) {
-            this->state->SetCallback(std::move(cb));
-            state = {};
+    using rawResT = det::then_ret_t<T, Cb>;
+    if constexpr (std::is_invocable_v<Cb, FutureResult<T>> && std::is_void_v<rawResT>) {
+        if (!ready.Empty()) {
+            cb(ready.Get());
+            ready.Reset();
         } else {
-            Promise<resT> chain;
-            auto fut = chain.GetFuture();
-            this->state->SetCallback([MV(cb), MV(chain)](FutureResult<T> res) mutable noexcept
-            {
-                try {
-                    if constexpr (is_future<rawResT>::value) {
-                        cb(std::move(res)).Then(std::move(chain));
-                    } else {
-                        chain.Resolve(cb(std::move(res)));
-                    }
-                } catch (...) {chain.Resolve(std::current_exception());}
-            });
+            this->state->SetCallback(std::move(cb));
             state = {};
-            return fut;
         }
-    } else if constexpr (!std::is_void_v<T> && std::is_invocable_v<Cb, T>) {
-        using rawResT = std::invoke_result_t<Cb, T>;
-        using resT = typename det::strip_fut<rawResT>::type;
-        Promise<resT> chain;
-        auto fut = chain.GetFuture();
-        this->state->SetCallback([MV(cb), MV(chain)](FutureResult<T> res) mutable noexcept
-        {
-            if (!res) {
-                chain.Resolve(res.MoveException());
-            } else try {
-                auto& pass = *res.Result();
-                if constexpr (std::is_void_v<rawResT>) {
-                    cb(std::move(pass));
-                    chain.Resolve();
-                } else if constexpr (is_future<rawResT>::value) {
-                    cb(std::move(pass)).Then(std::move(chain));
-                } else {
-                    chain.Resolve(cb(std::move(pass)));
-                }
-            } catch (...) {chain.Resolve(std::current_exception());}
-        });
-        state = {};
-        return fut;
-    } else if constexpr (std::is_void_v<T> && std::is_invocable_v<Cb>) {
-        using rawResT = std::invoke_result_t<Cb>;
+    } else {
         using resT = typename det::strip_fut<rawResT>::type;
+        if (!ready.Empty()) {
+            Future<resT> res;
+            det::ReadySink<resT> sink(res);
+            det::runThen<T>(cb, ready.Get(), sink);
+            ready.Reset();
+            return res;
+        }
         Promise<resT> chain;
         auto fut = chain.GetFuture();
-        this->state->SetCallback([MV(cb), MV(chain)](FutureResult<T> res) mutable noexcept
-        {
-            if (!res) {
-                chain.Resolve(res.MoveException());
-            } else try {
-                    if constexpr (std::is_void_v<rawResT>) {
-                        cb(); chain.Resolve();
-                    } else if constexpr (is_future<rawResT>::value) {
-                        cb().Then(std::move(chain));
-                    } else {
-                        chain.Resolve(cb());
-                    }
-                } catch (...) {chain.Resolve(std::current_exception());}
+        linkCancel(chain);
+        this->state->SetCallback([MV(cb), MV(chain)](FutureResult<T> res) mutable noexcept {
+            det::runThen<T>(cb, std::move(res), chain);
         });
         state = {};
         return fut;
-    } else {
-        static_assert(always_false<Cb>, "Invalid callback => must accept Result<T> or T");
     }
 }
 
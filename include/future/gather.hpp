@@ -4,6 +4,9 @@
 #include "future.hpp"
 #include <vector>
 #include <memory>
+#include <variant>
+#include <optional>
+#include <stdexcept>
 
 namespace fut
 {
@@ -18,7 +21,8 @@ namespace detail
 template<typename...Args>
 struct GatherCtx {
     std::tuple<non_void_t<Args>...> results {};
-    size_t doneCount = {};
+    std::atomic<size_t> doneCount = {};
+    std::atomic<bool> failed = false;
     Promise<std::tuple<non_void_t<Args>...>> setter {};
 };
 
@@ -28,16 +32,16 @@ using SharedGatherCtx = std::shared_ptr<GatherCtx<Args...>>;
 template<size_t idx, typename T, typename...Args>
 void handleSingleProm(SharedGatherCtx<Args...> ctx, Future<T> prom)
 {
-    prom.Then([ctx](auto res){
-        if(!ctx->setter.IsValid())
-            return;
+    prom.Then([ctx](FutureResult<T> res){
         if (auto&& err = res.Exception()) {
-            ctx->setter.Resolve(std::move(err));
+            if (!ctx->failed.exchange(true, std::memory_order_acq_rel))
+                ctx->setter.Resolve(std::move(err));
         } else {
             if constexpr (!std::is_void_v<T>)
                 std::get<idx>(ctx->results) = std::move(*res.Result());
-            if (++ctx->doneCount == sizeof...(Args)) {
-                ctx->setter.Resolve(std::move(ctx->results));
+            if (ctx->doneCount.fetch_add(1, std::memory_order_acq_rel) + 1 == sizeof...(Args)) {
+                if (!ctx->failed.load(std::memory_order_acquire))
+                    ctx->setter.Resolve(std::move(ctx->results));
             }
         }
     });
@@ -58,54 +62,215 @@ Future<std::tuple<non_void_t<Args>...>> Gather(Future<Args>...futs)
 {
     static_assert(sizeof...(Args), "Empty Promise List");
     using Ctx = detail::GatherCtx<Args...>;
-    auto ctx = std::make_shared<Ctx>(Ctx{});
+    auto ctx = std::make_shared<Ctx>();
     auto gathered = ctx->setter.GetFuture();
     callGatherHandlers(std::move(ctx), std::index_sequence_for<Args...>{}, std::move(futs)...);
     return gathered;
 }
 
+namespace detail
+{
+
+// Shared by all per-future callbacks: results are written by index into
+// presized storage, the last one to count down resolves
+template<typename T>
+struct VecGatherCtx {
+    using result_type = std::vector<T>;
+    // vector<bool> packs bits => concurrent writes to neighbours would race
+    static constexpr bool direct = std::is_default_constructible_v<T> && !std::is_same_v<T, bool>;
+    using slot_type = std::conditional_t<direct, T, std::optional<T>>;
+
+    explicit VecGatherCtx(size_t count) : refs(count), left(count), slots(count) {}
+    void Set(size_t idx, T&& value) {
+        slots[idx] = std::move(value);
+    }
+    result_type Take() {
+        if constexpr (direct) {
+            return std::move(slots);
+        } else {
+            result_type res;
+            res.reserve(slots.size());
+            for (auto& s: slots) res.push_back(std::move(*s));
+            return res;
+        }
+    }
+    std::atomic<size_t> refs;
+    std::atomic<size_t> left;
+    std::atomic<bool> failed = false;
+    std::vector<slot_type> slots;
+    Promise<result_type> prom;
+};
+
+template<>
+struct VecGatherCtx<void> {
+    explicit VecGatherCtx(size_t count) : refs(count), left(count) {}
+    std::atomic<size_t> refs;
+    std::atomic<size_t> left;
+    std::atomic<bool> failed = false;
+    Promise<void> prom;
+};
+
+// one ref per callback, released even if callback is dropped without a call
+template<typename Ctx>
+struct CtxRef {
+    explicit CtxRef(Ctx* ctx) noexcept : ctx(ctx) {}
+    CtxRef(CtxRef&& o) noexcept : ctx(std::exchange(o.ctx, nullptr)) {}
+    Ctx* operator->() const noexcept {
+        return ctx;
+    }
+    ~CtxRef() {
+        if (ctx && ctx->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete ctx;
+        }
+    }
+private:
+    Ctx* ctx;
+};
+
+}
+
+// Results keep order of input futures. First exception is forwarded
 template<typename T>
 auto Gather(std::vector<Future<T>> futs)
 {
     using promT = std::conditional_t<std::is_void_v<T>, void, std::vector<T>>;
-    using resultsT = std::conditional_t<std::is_void_v<T>, empty, std::vector<T>>;
     if (futs.empty()) {
         if constexpr (!std::is_void_v<T>)
             return FutureFromResult(promT{});
         else
             return FutureFromVoid();
     }
-    struct Base {
-        resultsT results;
-    };
-    struct Ctx : Base {
-        Promise<promT> prom;
-        size_t left;
-    };
-    auto ctx = std::make_shared<Ctx>();
-    ctx->left = futs.size();
+    using Ctx = detail::VecGatherCtx<T>;
+    auto ctx = new Ctx(futs.size());
     auto final = ctx->prom.GetFuture();
-    for (auto& f: futs) {
-        f.Then([ctx](auto res){
-            if (!ctx->prom.IsValid())
+    for (size_t i = 0; i < futs.size(); ++i) {
+        futs[i].Then([ref = detail::CtxRef<Ctx>(ctx), i](FutureResult<T> res){
+            if (!res) {
+                if (!ref->failed.exchange(true, std::memory_order_acq_rel))
+                    ref->prom.Resolve(res.MoveException());
                 return;
-            if (res) {
+            }
+            if constexpr (!std::is_void_v<T>)
+                ref->Set(i, std::move(*res.Result()));
+            if (ref->left.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                if (ref->failed.load(std::memory_order_acquire))
+                    return;
                 if constexpr (!std::is_void_v<T>)
-                    ctx->results.emplace_back(std::move(*res.Result()));
-                if (!--ctx->left) {                    
-                    if constexpr (!std::is_void_v<T>)
-                        ctx->prom.Resolve(std::move(ctx->results));
-                    else
-                        ctx->prom.Resolve();
-                }
-            } else {
-                ctx->prom.Resolve(res.Exception());
+                    ref->prom.Resolve(ref->Take());
+                else
+                    ref->prom.Resolve();
             }
         });
     }
     return final;
 }
 
+namespace detail
+{
+
+template<typename...Args>
+struct AnyCtx {
+    using result_type = std::variant<non_void_t<Args>...>;
+    std::tuple<FutureState<Args>...> states {};
+    std::atomic<bool> done = false;
+    std::atomic<size_t> failed = 0;
+    Promise<result_type> setter {};
+    void CancelLosers() noexcept {
+        std::apply([](auto&...st){((st ? st->Cancel() : void()), ...);}, states);
+        states = {};
+    }
+};
+
+template<size_t idx, typename T, typename...Args>
+void handleAnyProm(std::shared_ptr<AnyCtx<Args...>> ctx, Future<T> prom)
+{
+    using resT = typename AnyCtx<Args...>::result_type;
+    prom.Then([ctx](FutureResult<T> res){
+        if (res) {
+            if (ctx->done.exchange(true, std::memory_order_acq_rel))
+                return;
+            if constexpr (std::is_void_v<T>)
+                ctx->setter.Resolve(resT(std::in_place_index<idx>));
+            else
+                ctx->setter.Resolve(resT(std::in_place_index<idx>, std::move(*res.Result())));
+            ctx->CancelLosers();
+        } else if (ctx->failed.fetch_add(1, std::memory_order_acq_rel) + 1 == sizeof...(Args)) {
+            if (ctx->done.exchange(true, std::memory_order_acq_rel))
+                return;
+            ctx->setter.Resolve(res.MoveException());
+            ctx->states = {};
+        }
+    });
+}
+
+template<size_t...idx, typename...Args>
+void callAnyHandlers(std::shared_ptr<AnyCtx<Args...>> ctx,
+                     std::index_sequence<idx...>,
+                     Future<Args>...proms)
+{
+    (handleAnyProm<idx>(ctx, std::move(proms)), ...);
+}
+
+}
+
+// Resolves with first successful result (variant index == argument index), others get Cancel()-ed.
+// If all fail => last exception is forwarded
+template<typename...Args>
+Future<std::variant<non_void_t<Args>...>> WhenAny(Future<Args>...futs)
+{
+    static_assert(sizeof...(Args), "Empty Promise List");
+    using Ctx = detail::AnyCtx<Args...>;
+    auto ctx = std::make_shared<Ctx>();
+    ctx->states = {FutureState<Args>(futs.PeekState())...};
+    auto first = ctx->setter.GetFuture();
+    callAnyHandlers(std::move(ctx), std::index_sequence_for<Args...>{}, std::move(futs)...);
+    return first;
+}
+
+// Resolves with (index, value) of first successful future (only index for void), others get Cancel()-ed.
+// If all fail => last exception is forwarded
+template<typename T>
+auto WhenAny(std::vector<Future<T>> futs)
+{
+    using resT = std::conditional_t<std::is_void_v<T>, size_t, std::pair<size_t, non_void_t<T>>>;
+    if (futs.empty()) {
+        return FutureFromException<resT>(std::invalid_argument("WhenAny(): empty futures list"));
+    }
+    struct Ctx {
+        std::vector<FutureState<T>> states;
+        std::atomic<bool> done = false;
+        std::atomic<size_t> failed = 0;
+        Promise<resT> prom;
+    };
+    auto ctx = std::make_shared<Ctx>();
+    ctx->states.reserve(futs.size());
+    for (auto& f: futs) {
+        ctx->states.emplace_back(f.PeekState());
+    }
+    auto first = ctx->prom.GetFuture();
+    auto total = futs.size();
+    for (size_t i = 0; i < total; ++i) {
+        futs[i].Then([ctx, i, total](FutureResult<T> res){
+            if (res) {
+                if (ctx->done.exchange(true, std::memory_order_acq_rel))
+                    return;
+                if constexpr (std::is_void_v<T>)
+                    ctx->prom.Resolve(i);
+                else
+                    ctx->prom.Resolve(resT{i, std::move(*res.Result())});
+                for (auto& st: ctx->states) if (st) st->Cancel();
+                ctx->states.clear();
+            } else if (ctx->failed.fetch_add(1, std::memory_order_acq_rel) + 1 == total) {
+                if (ctx->done.exchange(true, std::memory_order_acq_rel))
+                    return;
+                ctx->prom.Resolve(res.MoveException());
+                ctx->states.clear();
+            }
+        });
+    }
+    return first;
+}
+
 } //fut
 
 #endif //FUT_GATHER_HPP
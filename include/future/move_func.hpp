@@ -1,12 +1,15 @@
 #ifndef FUT_CALL_ONCE_HPP
 #define FUT_CALL_ONCE_HPP
 
+#include <new>
 #include <cassert>
 #include <stdexcept>
+#include <memory>
 #include <utility>
 #include <cstddef>
 #include <type_traits>
 #include "meta/meta.hpp"
+#include "alloc.hpp"
 
 namespace fut {
 
@@ -20,6 +23,12 @@ struct InvalidMoveFuncCall : public std::exception {
     }
 };
 
+template<typename Ret, typename...Args>
+struct FuncSig {
+    using R = Ret;
+    using A = meta::TypeList<Args...>;
+};
+
 namespace call {
 
 template<size_t SOO> union Storage {
@@ -27,86 +36,150 @@ template<size_t SOO> union Storage {
     void* _big;
 };
 
-template<size_t SOO, typename Ret, typename...Args>
-struct Manager {
-    virtual void destroy(Storage<SOO>* stor) noexcept = 0;
-    virtual void move(Storage<SOO>* from, Storage<SOO>* to) noexcept = 0;
-    virtual Ret call(Storage<SOO>* stor, Args...a) = 0;
-protected:
-    ~Manager() = default;
+// Allocators for callables, that do not fit into SOO buffer:
+// static Allocate<Size, Align>() / Deallocate<Size, Align>(p)
+
+struct NewAlloc {
+    template<size_t Size, size_t Align>
+    static void* Allocate() {
+        if constexpr (Align > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+            return ::operator new(Size, std::align_val_t(Align));
+        else
+            return ::operator new(Size);
+    }
+    template<size_t Size, size_t Align>
+    static void Deallocate(void* p) noexcept {
+        if constexpr (Align > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+            ::operator delete(p, std::align_val_t(Align));
+        else
+            ::operator delete(p);
+    }
 };
 
-template<typename Fn, size_t SOO, typename Ret, typename...Args>
-struct ManagerImpl final : Manager<SOO, Ret, Args...> {
+// per-thread BlockPool for typical captures, plain new for huge ones
+struct PoolAlloc {
+    static constexpr size_t maxPooled = 256;
+    template<size_t Size, size_t Align>
+    static void* Allocate() {
+        if constexpr (Size <= maxPooled)
+            return BlockPool<Size, Align>::Allocate();
+        else
+            return NewAlloc::Allocate<Size, Align>();
+    }
+    template<size_t Size, size_t Align>
+    static void Deallocate(void* p) noexcept {
+        if constexpr (Size <= maxPooled)
+            BlockPool<Size, Align>::Deallocate(p);
+        else
+            NewAlloc::Deallocate<Size, Align>(p);
+    }
+};
+
+enum class Op {
+    move,
+    copy,
+    destroy,
+};
+
+// only Op::copy may throw
+template<size_t SOO>
+using ManageFn = void(*)(Op op, Storage<SOO>* from, Storage<SOO>* to);
+
+template<size_t SOO, typename Ret, typename...Args>
+using InvokeFn = Ret(*)(Storage<SOO>* stor, Args...a);
+
+template<typename Fn, size_t SOO, typename Alloc>
+struct Handler {
+    static constexpr bool big = sizeof(Fn) > SOO || alignof(Fn) > alignof(std::max_align_t);
+    // inline + trivially copyable => moved by copying storage, never destroyed => no manager
+    static constexpr bool trivial = !big && std::is_trivially_copyable_v<Fn>;
+
     meta_alwaysInline static Fn& get(Storage<SOO>* stor) noexcept {
-        if constexpr (sizeof(Fn) > SOO)
+        if constexpr (big)
             return *static_cast<Fn*>(stor->_big);
         else
             return *std::launder(reinterpret_cast<Fn*>(stor->_small));
     }
-    void destroy(Storage<SOO>* stor) noexcept final {
-        if constexpr (sizeof(Fn) > SOO)
-            delete &get(stor);
-        else
-            get(stor).~Fn();
-    }
-    void move(Storage<SOO>* from, Storage<SOO>* to) noexcept final {
-        if constexpr (sizeof(Fn) > SOO) {
+    static void manage(Op op, Storage<SOO>* from, Storage<SOO>* to) {
+        if (op == Op::destroy) {
+            get(from).~Fn();
+            if constexpr (big)
+                Alloc::template Deallocate<sizeof(Fn), alignof(Fn)>(from->_big);
+        } else if (op == Op::copy) {
+            // only requested by Function<>, which requires copyable Fn
+            if constexpr (std::is_copy_constructible_v<Fn>)
+                create(to, std::as_const(get(from)));
+        } else if constexpr (big) {
             to->_big = std::exchange(from->_big, nullptr);
         } else {
             new (to->_small) Fn(std::move(get(from)));
             get(from).~Fn();
         }
     }
-    Ret call(Storage<SOO>* stor, Args...a) final {
+    template<typename F>
+    static void create(Storage<SOO>* stor, F&& f) {
+        if constexpr (big) {
+            auto mem = Alloc::template Allocate<sizeof(Fn), alignof(Fn)>();
+            try {
+                stor->_big = new (mem) Fn(std::forward<F>(f));
+            } catch (...) {
+                Alloc::template Deallocate<sizeof(Fn), alignof(Fn)>(mem);
+                throw;
+            }
+        } else {
+            new (stor->_small) Fn(std::forward<F>(f));
+        }
+    }
+    template<typename Ret, typename...Args>
+    static Ret invoke(Storage<SOO>* stor, Args...a) {
         return get(stor)(std::forward<Args>(a)...);
     }
 };
-} //call
-
-template<typename Ret, typename...Args>
-struct FuncSig {
-    using R = Ret;
-    using A = meta::TypeList<Args...>;
-};
 
-template<typename Sig, size_t SOO = DEFAULT_SOO> class MoveFunc;
-
-template<typename Ret, typename...Args, size_t SOO>
-class MoveFunc<Ret(Args...), SOO>
+// Shared by MoveFunc/Function (+ noexcept signatures)
+template<bool Nothrow, bool Copyable, size_t SOO, typename Alloc, typename Ret, typename...Args>
+class FuncImpl
 {
-    call::Storage<SOO> stor = {};
-    call::Manager<SOO, Ret, Args...>* manager = nullptr;
+protected:
+    Storage<SOO> stor = {};
+    InvokeFn<SOO, Ret, Args...> invoke = nullptr;
+    ManageFn<SOO> manage = nullptr;
 public:
     using Sig = FuncSig<Ret, Args...>;
     static constexpr auto SOO_size = SOO;
-    MoveFunc() noexcept = default;
+    FuncImpl() noexcept = default;
     template<typename Fn>
-    MoveFunc(Fn f) {
+    FuncImpl(Fn f) {
         static_assert(std::is_move_constructible_v<Fn>);
+        static_assert(!Copyable || std::is_copy_constructible_v<Fn>, "Function<> requires copyable callable");
         static_assert(std::is_invocable_v<Fn, Args&&...>);
+        static_assert(!Nothrow || std::is_nothrow_invocable_v<Fn, Args&&...>, "noexcept signature requires noexcept callable");
         static_assert(std::is_convertible_v<std::invoke_result_t<Fn, Args&&...>, Ret>);
-        static call::ManagerImpl<Fn, SOO, Ret, Args...> impl;
-        manager = &impl;
-        if constexpr (sizeof(Fn) > SOO) {
-            stor._big = new Fn(std::move(f));
-        } else {
-            new (stor._small) Fn(std::move(f));
+        using H = Handler<Fn, SOO, Alloc>;
+        H::create(&stor, std::move(f));
+        invoke = &H::template invoke<Ret, Args...>;
+        if constexpr (!H::trivial) {
+            manage = &H::manage;
         }
     }
     explicit operator bool() const noexcept {
-        return manager;
+        return invoke;
     }
-    meta_alwaysInline Ret operator()(Args...a) {
-        if (!manager) {
+    // noexcept signature => no emptiness check
+    meta_alwaysInline Ret operator()(Args...a) noexcept(Nothrow) {
+        if constexpr (Nothrow) {
+            assert(invoke && "Invalid MoveFunc Call");
+        } else if (!invoke) {
             throw InvalidMoveFuncCall();
         }
-        return manager->call(&stor, std::forward<Args>(a)...);
+        return invoke(&stor, std::forward<Args>(a)...);
     }
-    MoveFunc(MoveFunc&& oth) noexcept {
+    FuncImpl(const FuncImpl&) = delete;
+    FuncImpl(FuncImpl&& oth) noexcept {
         moveIn(oth);
     }
-    MoveFunc& operator=(MoveFunc&& oth) noexcept {
+    FuncImpl& operator=(const FuncImpl&) = delete;
+    FuncImpl& operator=(FuncImpl&& oth) noexcept {
         // cannot just swap => cannot swap small storage for
         // non-trivially movable types (pinned-like)
         if (this != &oth) {
@@ -115,23 +188,164 @@ public:
         }
         return *this;
     }
-    ~MoveFunc() {
+    ~FuncImpl() {
         deref();
     }
+protected:
+    void copyIn(const FuncImpl& oth) {
+        if (oth.manage) {
+            oth.manage(Op::copy, const_cast<Storage<SOO>*>(&oth.stor), &stor);
+        } else {
+            stor = oth.stor;
+        }
+        invoke = oth.invoke;
+        manage = oth.manage;
+    }
 private:
     void deref() noexcept {
-        if (manager) {
-            manager->destroy(&stor);
+        if (manage) {
+            manage(Op::destroy, &stor, nullptr);
         }
     }
-    void moveIn(MoveFunc& oth) noexcept {
-        manager = std::exchange(oth.manager, nullptr);
-        if (manager) {
-            manager->move(&oth.stor, &stor);
+    void moveIn(FuncImpl& oth) noexcept {
+        invoke = std::exchange(oth.invoke, nullptr);
+        manage = std::exchange(oth.manage, nullptr);
+        if (manage) {
+            manage(Op::move, &oth.stor, &stor);
+        } else {
+            stor = oth.stor;
         }
     }
 };
 
+template<bool Nothrow, typename Ret, typename...Args>
+class RefImpl
+{
+    union Target {
+        void* obj;
+        void (*fn)();
+    } target;
+    Ret (*invoke)(Target, Args...);
+    template<typename Fn>
+    static constexpr bool invocable = std::conditional_t<Nothrow,
+        std::is_nothrow_invocable_r<Ret, Fn&, Args...>, std::is_invocable_r<Ret, Fn&, Args...>>::value;
+public:
+    template<typename Fn, typename = std::enable_if_t<
+        !std::is_base_of_v<RefImpl, std::decay_t<Fn>> && invocable<Fn>>>
+    RefImpl(Fn&& f) noexcept {
+        using F = std::remove_reference_t<Fn>;
+        using P = std::remove_cv_t<F>;
+        if constexpr (std::is_function_v<F>) {
+            target.fn = reinterpret_cast<void(*)()>(&f);
+            invoke = [](Target t, Args...a) noexcept(Nothrow) -> Ret {
+                return reinterpret_cast<F*>(t.fn)(std::forward<Args>(a)...);
+            };
+        } else if constexpr (std::is_pointer_v<P> && std::is_function_v<std::remove_pointer_t<P>>) {
+            // by value: FunctionRef(&foo) must not point to a temporary pointer
+            target.fn = reinterpret_cast<void(*)()>(f);
+            invoke = [](Target t, Args...a) noexcept(Nothrow) -> Ret {
+                return reinterpret_cast<P>(t.fn)(std::forward<Args>(a)...);
+            };
+        } else {
+            target.obj = const_cast<void*>(static_cast<const volatile void*>(std::addressof(f)));
+            invoke = [](Target t, Args...a) noexcept(Nothrow) -> Ret {
+                return (*static_cast<F*>(t.obj))(std::forward<Args>(a)...);
+            };
+        }
+    }
+    Ret operator()(Args...a) const noexcept(Nothrow) {
+        return invoke(target, std::forward<Args>(a)...);
+    }
+};
+
+} //call
+
+// Owning move-only callable
+template<typename Sig, size_t SOO = DEFAULT_SOO, typename Alloc = call::PoolAlloc> class MoveFunc;
+
+template<typename Ret, typename...Args, size_t SOO, typename Alloc>
+class MoveFunc<Ret(Args...), SOO, Alloc> :
+    public call::FuncImpl<false, false, SOO, Alloc, Ret, Args...>
+{
+    using Impl = call::FuncImpl<false, false, SOO, Alloc, Ret, Args...>;
+public:
+    using Impl::Impl;
+    MoveFunc() noexcept = default;
+};
+
+template<typename Ret, typename...Args, size_t SOO, typename Alloc>
+class MoveFunc<Ret(Args...) noexcept, SOO, Alloc> :
+    public call::FuncImpl<true, false, SOO, Alloc, Ret, Args...>
+{
+    using Impl = call::FuncImpl<true, false, SOO, Alloc, Ret, Args...>;
+public:
+    using Impl::Impl;
+    MoveFunc() noexcept = default;
+};
+
+// Owning copyable callable (std::function analog with MoveFunc storage)
+template<typename Sig, size_t SOO = DEFAULT_SOO, typename Alloc = call::PoolAlloc> class Function;
+
+template<typename Ret, typename...Args, size_t SOO, typename Alloc>
+class Function<Ret(Args...), SOO, Alloc> :
+    public call::FuncImpl<false, true, SOO, Alloc, Ret, Args...>
+{
+    using Impl = call::FuncImpl<false, true, SOO, Alloc, Ret, Args...>;
+public:
+    using Impl::Impl;
+    Function() noexcept = default;
+    Function(const Function& oth) : Impl() {
+        this->copyIn(oth);
+    }
+    Function(Function&&) noexcept = default;
+    Function& operator=(const Function& oth) {
+        if (this != &oth) {
+            *this = Function(oth);
+        }
+        return *this;
+    }
+    Function& operator=(Function&&) noexcept = default;
+};
+
+template<typename Ret, typename...Args, size_t SOO, typename Alloc>
+class Function<Ret(Args...) noexcept, SOO, Alloc> :
+    public call::FuncImpl<true, true, SOO, Alloc, Ret, Args...>
+{
+    using Impl = call::FuncImpl<true, true, SOO, Alloc, Ret, Args...>;
+public:
+    using Impl::Impl;
+    Function() noexcept = default;
+    Function(const Function& oth) : Impl() {
+        this->copyIn(oth);
+    }
+    Function(Function&&) noexcept = default;
+    Function& operator=(const Function& oth) {
+        if (this != &oth) {
+            *this = Function(oth);
+        }
+        return *this;
+    }
+    Function& operator=(Function&&) noexcept = default;
+};
+
+// Non-owning reference to a callable (two pointers, never allocates).
+// Must not outlive the callable => only for synchronous use (parameters of visitors, hooks)
+template<typename Sig> class FunctionRef;
+
+template<typename Ret, typename...Args>
+class FunctionRef<Ret(Args...)> : public call::RefImpl<false, Ret, Args...>
+{
+public:
+    using call::RefImpl<false, Ret, Args...>::RefImpl;
+};
+
+template<typename Ret, typename...Args>
+class FunctionRef<Ret(Args...) noexcept> : public call::RefImpl<true, Ret, Args...>
+{
+public:
+    using call::RefImpl<true, Ret, Args...>::RefImpl;
+};
+
 template<typename Ret, typename...Args>
 MoveFunc(Ret(*)(Args...)) -> MoveFunc<Ret(Args...)>;
 
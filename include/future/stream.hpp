@@ -0,0 +1,291 @@
+#ifndef FUT_STREAM_HPP
+#define FUT_STREAM_HPP
+
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include "future.hpp"
+#include "executor.hpp"
+
+namespace fut
+{
+
+struct ChannelClosed : public std::exception {
+    const char* what() const noexcept override {
+        return "Channel Closed";
+    }
+};
+
+// Items of one delivery, valid only during the callback (may be moved out)
+template<typename T>
+struct Batch {
+    T* data() const noexcept {return items;}
+    size_t size() const noexcept {return count;}
+    bool empty() const noexcept {return !count;}
+    T* begin() const noexcept {return items;}
+    T* end() const noexcept {return items + count;}
+    T& operator[](size_t i) const noexcept {return items[i];}
+
+    T* items;
+    size_t count;
+};
+
+template<typename T> struct Channel;
+template<typename T> struct Stream;
+
+namespace det {
+
+template<typename T>
+struct ChannelState {
+    using Ptr = std::shared_ptr<ChannelState>;
+
+    explicit ChannelState(size_t capacity) : capacity(capacity ? capacity : 1) {}
+
+    // lock is held, releases it
+    static void schedule(const Ptr& self, std::unique_lock<std::mutex>& lock) {
+        auto& st = *self;
+        bool work = !st.buffer.empty() || (st.closed && st.waiting.empty());
+        if (!st.onBatch || st.delivering || st.finished || !work) {
+            return;
+        }
+        st.delivering = true;
+        lock.unlock();
+        if (st.executor) {
+            st.executor([self]{drain(self);});
+        } else {
+            drain(self);
+        }
+    }
+    // single drainer at a time (delivering flag), batches reuse one vector.
+    // onBatch is released only here or when no drain runs => callback may Stop() itself
+    static void drain(const Ptr& self) noexcept {
+        auto& st = *self;
+        std::unique_lock lock(st.mut);
+        for (;;) {
+            if (st.buffer.empty()) {
+                if (st.closed && st.waiting.empty()) {
+                    st.finish(lock);
+                } else {
+                    st.delivering = false;
+                }
+                return;
+            }
+            auto n = st.buffer.size() < st.maxBatch ? st.buffer.size() : st.maxBatch;
+            st.batch.clear();
+            for (size_t i = 0; i < n; ++i) {
+                st.batch.push_back(std::move(st.buffer.front()));
+                st.buffer.pop_front();
+            }
+            auto admitted = st.admit();
+            lock.unlock();
+            for (auto& p: admitted) {
+                p.Resolve();
+            }
+            try {
+                st.onBatch(Batch<T>{st.batch.data(), st.batch.size()});
+            } catch (...) {
+                lock.lock();
+                st.fail(lock, std::current_exception());
+            }
+            lock.lock();
+        }
+    }
+    // senders parked by backpressure move into freed room
+    std::vector<Promise<void>> admit() {
+        std::vector<Promise<void>> res;
+        while (!waiting.empty() && buffer.size() < capacity) {
+            buffer.push_back(std::move(waiting.front().first));
+            res.push_back(std::move(waiting.front().second));
+            waiting.pop_front();
+        }
+        return res;
+    }
+    // consumer is gone (or failed): nothing will be delivered anymore. Releases lock
+    void fail(std::unique_lock<std::mutex>& lock, std::exception_ptr why) {
+        if (consumerGone) {
+            lock.unlock();
+            return;
+        }
+        closed = consumerGone = true;
+        error = std::move(why);
+        buffer.clear();
+        auto parked = std::move(waiting);
+        if (delivering) {
+            // drain() finishes, once current callback returns
+            lock.unlock();
+        } else {
+            finish(lock);
+        }
+        for (auto& [_, p]: parked) {
+            p.Resolve(ChannelClosed{});
+        }
+    }
+    // no drain is running (or caller is drain() itself). Releases lock
+    void finish(std::unique_lock<std::mutex>& lock) {
+        delivering = false;
+        if (finished) {
+            lock.unlock();
+            return;
+        }
+        finished = true;
+        auto prom = std::move(done);
+        auto cb = std::move(onBatch);
+        auto why = error;
+        lock.unlock();
+        if (!prom.IsValid()) return;
+        if (why) prom.Resolve(std::move(why));
+        else prom.Resolve();
+    }
+
+    std::mutex mut;
+    std::deque<T> buffer;
+    std::deque<std::pair<T, Promise<void>>> waiting;
+    std::vector<T> batch;
+    size_t capacity;
+    size_t maxBatch = SIZE_MAX;
+    MoveFunc<void(Batch<T>)> onBatch;
+    MoveFunc<void(Task)> executor;
+    Promise<void> done;
+    std::exception_ptr error;
+    std::atomic<int> senders = 1;
+    bool closed = false;
+    bool consumerGone = false;
+    bool delivering = false;
+    bool finished = false;
+    bool streamTaken = false;
+};
+
+} //det
+
+// Producer side of a bounded multi-shot channel. Copies share the channel,
+// it is closed when the last copy dies (or on Close())
+template<typename T>
+struct Channel {
+    explicit Channel(size_t capacity = 1024) :
+        st(std::make_shared<det::ChannelState<T>>(capacity))
+    {}
+    Channel(const Channel& o) noexcept : st(o.st) {
+        if (st) st->senders.fetch_add(1, std::memory_order_relaxed);
+    }
+    Channel(Channel&& o) noexcept = default;
+    Channel& operator=(Channel o) noexcept {
+        std::swap(st, o.st);
+        return *this;
+    }
+    // consumer end, may be taken once
+    Stream<T> GetStream();
+    // ready future if there is room, otherwise resolved once the item is admitted (backpressure).
+    // ChannelClosed if channel or consumer is closed
+    Future<void> Send(T value) {
+        std::unique_lock lock(st->mut);
+        if (meta_Unlikely(st->closed)) {
+            return FutureFromException<void>(ChannelClosed{});
+        }
+        if (st->buffer.size() < st->capacity) {
+            st->buffer.push_back(std::move(value));
+            det::ChannelState<T>::schedule(st, lock);
+            return FutureFromVoid();
+        }
+        Promise<void> prom;
+        auto fut = prom.GetFuture();
+        st->waiting.emplace_back(std::move(value), std::move(prom));
+        return fut;
+    }
+    // no future: false (value untouched) if full or closed
+    bool TrySend(T&& value) {
+        std::unique_lock lock(st->mut);
+        if (st->closed || st->buffer.size() >= st->capacity) {
+            return false;
+        }
+        st->buffer.push_back(std::move(value));
+        det::ChannelState<T>::schedule(st, lock);
+        return true;
+    }
+    // already buffered items are still delivered, then consumer's future resolves (with error if any)
+    void Close(std::exception_ptr error = nullptr) {
+        std::unique_lock lock(st->mut);
+        if (st->closed) return;
+        st->closed = true;
+        st->error = std::move(error);
+        det::ChannelState<T>::schedule(st, lock);
+    }
+    bool IsClosed() const {
+        std::lock_guard lock(st->mut);
+        return st->closed;
+    }
+    ~Channel() {
+        if (st && st->senders.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            Close();
+        }
+    }
+private:
+    std::shared_ptr<det::ChannelState<T>> st;
+};
+
+// Consumer side: items are pushed in batches of up to maxBatch to a single callback.
+// If dropped before OnBatch() (or on Stop()), senders get ChannelClosed
+template<typename T>
+struct Stream {
+    Stream(Stream&&) noexcept = default;
+    Stream& operator=(Stream&&) noexcept = default;
+    // cb(Batch<T>) runs on the sending thread (one batch at a time).
+    // Returned future resolves after Close() and last batch (with error of Close() or of cb)
+    template<typename Cb>
+    Future<void> OnBatch(Cb cb, size_t maxBatch = SIZE_MAX) {
+        return subscribe(MoveFunc<void(Task)>{}, std::move(cb), maxBatch);
+    }
+    // same, but every drain runs as a task on executor
+    template<typename Ex, typename Cb>
+    Future<void> OnBatch(Ex& executor, Cb cb, size_t maxBatch = SIZE_MAX) {
+        return subscribe([ex = &executor](Task task){ex->Execute(std::move(task));}, std::move(cb), maxBatch);
+    }
+    // stop consuming: drops buffered items, senders get ChannelClosed.
+    // May be called from inside the callback (it is released after it returns)
+    void Stop() {
+        if (!st) return;
+        std::unique_lock lock(st->mut);
+        st->fail(lock, nullptr);
+        st.reset();
+    }
+    ~Stream() {
+        if (st && !subscribed) Stop();
+    }
+private:
+    friend struct Channel<T>;
+    explicit Stream(std::shared_ptr<det::ChannelState<T>> st) noexcept : st(std::move(st)) {}
+    template<typename Cb>
+    Future<void> subscribe(MoveFunc<void(Task)> executor, Cb cb, size_t maxBatch) {
+        static_assert(std::is_invocable_v<Cb, Batch<T>>, "callback must accept Batch<T>");
+        if (meta_Unlikely(!st || subscribed)) {
+            assert(false && "OnBatch() called twice");
+            std::abort();
+        }
+        subscribed = true;
+        std::unique_lock lock(st->mut);
+        auto fut = st->done.GetFuture();
+        st->executor = std::move(executor);
+        st->maxBatch = maxBatch ? maxBatch : 1;
+        st->onBatch = std::move(cb);
+        det::ChannelState<T>::schedule(st, lock);
+        return fut;
+    }
+    std::shared_ptr<det::ChannelState<T>> st;
+    bool subscribed = false;
+};
+
+template<typename T>
+Stream<T> Channel<T>::GetStream() {
+    std::lock_guard lock(st->mut);
+    if (meta_Unlikely(std::exchange(st->streamTaken, true))) {
+        assert(false && "GetStream() called twice");
+        std::abort();
+    }
+    return Stream<T>(st);
+}
+
+} //fut
+
+#endif //FUT_STREAM_HPP
@@ -0,0 +1,297 @@
+#ifndef FUT_THREAD_POOL_HPP
+#define FUT_THREAD_POOL_HPP
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include "future.hpp"
+#include "executor.hpp"
+
+#ifdef __linux__
+#include <climits>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#else
+#include <condition_variable>
+#endif
+
+namespace fut
+{
+
+namespace det {
+
+// Chase-Lev deque (Le, Pop, Cohen, Nardelli 2013): owner pushes/pops bottom, thieves steal top.
+// Retired arrays are kept until destruction, since a thief may still be reading them
+struct WorkDeque {
+    explicit WorkDeque(size_t startCap = 256) {
+        auto first = std::make_unique<Array>(startCap);
+        array.store(first.get(), std::memory_order_relaxed);
+        arrays.push_back(std::move(first));
+    }
+    WorkDeque(const WorkDeque&) = delete;
+    // owner only
+    void Push(Task* task) {
+        auto b = bottom.load(std::memory_order_relaxed);
+        auto t = top.load(std::memory_order_acquire);
+        auto a = array.load(std::memory_order_relaxed);
+        if (b - t > int64_t(a->mask)) {
+            a = grow(a, t, b);
+        }
+        a->Put(b, task);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+    // owner only
+    Task* Pop() {
+        auto b = bottom.load(std::memory_order_relaxed) - 1;
+        auto a = array.load(std::memory_order_relaxed);
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto t = top.load(std::memory_order_relaxed);
+        if (t > b) {
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        auto task = a->Get(b);
+        if (t == b) {
+            // last item => race against thieves
+            if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                task = nullptr;
+            }
+            bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return task;
+    }
+    Task* Steal() {
+        auto t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto b = bottom.load(std::memory_order_acquire);
+        if (t >= b) {
+            return nullptr;
+        }
+        auto task = array.load(std::memory_order_acquire)->Get(t);
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return task;
+    }
+    bool Empty() const noexcept {
+        return bottom.load(std::memory_order_relaxed) <= top.load(std::memory_order_relaxed);
+    }
+private:
+    struct Array {
+        explicit Array(size_t cap) : mask(cap - 1), items(new std::atomic<Task*>[cap]) {}
+        void Put(int64_t i, Task* t) noexcept {
+            items[size_t(i) & mask].store(t, std::memory_order_relaxed);
+        }
+        Task* Get(int64_t i) const noexcept {
+            return items[size_t(i) & mask].load(std::memory_order_relaxed);
+        }
+        size_t mask;
+        std::unique_ptr<std::atomic<Task*>[]> items;
+    };
+    Array* grow(Array* old, int64_t t, int64_t b) {
+        auto bigger = std::make_unique<Array>((old->mask + 1) * 2);
+        for (auto i = t; i < b; ++i) {
+            bigger->Put(i, old->Get(i));
+        }
+        auto res = bigger.get();
+        arrays.push_back(std::move(bigger));
+        array.store(res, std::memory_order_release);
+        return res;
+    }
+    alignas(64) std::atomic<int64_t> top = 0;
+    alignas(64) std::atomic<int64_t> bottom = 0;
+    std::atomic<Array*> array;
+    std::vector<std::unique_ptr<Array>> arrays;
+};
+
+// Sleepers wait for epoch to change, producers bump it after publishing work
+struct Parker {
+    void Wait(uint32_t seenEpoch) noexcept {
+#ifdef __linux__
+        syscall(SYS_futex, &epoch, FUTEX_WAIT_PRIVATE, seenEpoch, nullptr, nullptr, 0);
+#else
+        std::unique_lock lock(mut);
+        cv.wait(lock, [&]{return epoch.load() != seenEpoch;});
+#endif
+    }
+    uint32_t Epoch() const noexcept {
+        return epoch.load(std::memory_order_seq_cst);
+    }
+    void Notify(bool all = false) noexcept {
+        epoch.fetch_add(1, std::memory_order_seq_cst);
+        if (!all && !sleeping.load(std::memory_order_seq_cst)) {
+            return;
+        }
+#ifdef __linux__
+        syscall(SYS_futex, &epoch, FUTEX_WAKE_PRIVATE, all ? INT_MAX : 1, nullptr, nullptr, 0);
+#else
+        {std::lock_guard lock(mut);}
+        if (all) cv.notify_all(); else cv.notify_one();
+#endif
+    }
+    std::atomic<uint32_t> epoch = 0;
+    std::atomic<int> sleeping = 0;
+#ifndef __linux__
+    std::mutex mut;
+    std::condition_variable cv;
+#endif
+};
+
+struct PoolWorker {
+    const void* pool = nullptr;
+    size_t index = 0;
+};
+
+} //det
+
+// Each worker owns a Chase-Lev deque: tasks spawned from a worker go to its own deque (LIFO, cache-warm),
+// tasks from outside go to the global injection queue. Idle workers steal, spin, then park on a futex.
+// Tasks should not throw. Destructor runs all queued tasks before joining
+struct WorkStealingPool final : Executor {
+    explicit WorkStealingPool(size_t threads = std::thread::hardware_concurrency(), unsigned spins = 64) :
+        spinCount(spins)
+    {
+        if (!threads) threads = 1;
+        workers.reserve(threads);
+        for (size_t i = 0; i < threads; ++i) {
+            workers.push_back(std::make_unique<Worker>());
+        }
+        for (size_t i = 0; i < threads; ++i) {
+            workers[i]->thread = std::thread([this, i]{work(i);});
+        }
+    }
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    void Execute(Task task) override {
+        auto t = new (TaskPool::Allocate()) Task(std::move(task));
+        if (current.pool == this) {
+            workers[current.index]->deque.Push(t);
+        } else {
+            std::lock_guard lock(injectMut);
+            injected.push_back(t);
+            injectedCount.fetch_add(1, std::memory_order_relaxed);
+        }
+        parker.Notify();
+    }
+    size_t Size() const noexcept {
+        return workers.size();
+    }
+    ~WorkStealingPool() override {
+        stopping.store(true, std::memory_order_seq_cst);
+        parker.Notify(true);
+        for (auto& w: workers) {
+            w->thread.join();
+        }
+        for (auto t: injected) dropTask(t);
+        for (auto& w: workers) {
+            while (auto t = w->deque.Pop()) dropTask(t);
+        }
+    }
+private:
+    struct Worker {
+        det::WorkDeque deque;
+        std::thread thread;
+    };
+    static inline thread_local det::PoolWorker current = {};
+    // deque slots hold pointers (thieves read them racily) => nodes come from per-thread pool
+    using TaskPool = BlockPool<sizeof(Task), alignof(Task)>;
+    static void dropTask(Task* task) noexcept {
+        task->~Task();
+        TaskPool::Deallocate(task);
+    }
+
+    Task* popInjected() {
+        if (!injectedCount.load(std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        std::lock_guard lock(injectMut);
+        if (injected.empty()) return nullptr;
+        auto t = injected.front();
+        injected.pop_front();
+        injectedCount.fetch_sub(1, std::memory_order_relaxed);
+        return t;
+    }
+    Task* findTask(size_t self, std::minstd_rand& rng) {
+        if (auto t = workers[self]->deque.Pop()) return t;
+        if (auto t = popInjected()) return t;
+        auto count = workers.size();
+        auto start = size_t(rng());
+        for (size_t i = 0; i < count; ++i) {
+            auto victim = (start + i) % count;
+            if (victim == self) continue;
+            if (auto t = workers[victim]->deque.Steal()) return t;
+        }
+        return nullptr;
+    }
+    void work(size_t self) {
+        current = {this, self};
+        std::minstd_rand rng(unsigned(self + 1));
+        for (;;) {
+            Task* task = nullptr;
+            for (unsigned spin = 0; !task && spin < spinCount; ++spin) {
+                task = findTask(self, rng);
+                if (!task) std::this_thread::yield();
+            }
+            if (!task) {
+                auto epoch = parker.Epoch();
+                parker.sleeping.fetch_add(1, std::memory_order_seq_cst);
+                task = findTask(self, rng);
+                if (!task) {
+                    if (stopping.load(std::memory_order_seq_cst)) {
+                        parker.sleeping.fetch_sub(1, std::memory_order_seq_cst);
+                        break;
+                    }
+                    parker.Wait(epoch);
+                }
+                parker.sleeping.fetch_sub(1, std::memory_order_seq_cst);
+                if (!task) continue;
+            }
+            (*task)();
+            dropTask(task);
+        }
+        current = det::PoolWorker{};
+    }
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::mutex injectMut;
+    std::deque<Task*> injected;
+    std::atomic<size_t> injectedCount = 0;
+    det::Parker parker;
+    std::atomic<bool> stopping = false;
+    unsigned spinCount;
+};
+
+// former shared-queue pool: same ctor and drain-on-destruction semantics
+using ThreadPoolExecutor = WorkStealingPool;
+
+// run fn on executor, Future<R> is resolved with its result (Future returns are flattened)
+template<typename Ex, typename Fn>
+auto Async(Ex& executor, Fn fn) {
+    using rawResT = std::invoke_result_t<Fn>;
+    using resT = typename det::strip_fut<rawResT>::type;
+    Promise<resT> prom;
+    auto fut = prom.GetFuture();
+    executor.Execute([MV(fn), MV(prom)]() mutable noexcept {
+        try {
+            if constexpr (std::is_void_v<rawResT>) {
+                fn();
+                prom.Resolve();
+            } else if constexpr (is_future<rawResT>::value) {
+                fn().Then(std::move(prom));
+            } else {
+                prom.Resolve(fn());
+            }
+        } catch (...) {prom.Resolve(std::current_exception());}
+    });
+    return fut;
+}
+
+} //fut
+
+#endif //FUT_THREAD_POOL_HPP
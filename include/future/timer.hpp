@@ -0,0 +1,322 @@
+#ifndef FUT_TIMER_HPP
+#define FUT_TIMER_HPP
+
+#include <chrono>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <thread>
+#include <cstdint>
+#include <stdexcept>
+#include "future.hpp"
+
+namespace fut
+{
+
+using Duration = std::chrono::nanoseconds;
+
+struct SteadyClock {
+    Duration Now() const noexcept {
+        return std::chrono::steady_clock::now().time_since_epoch();
+    }
+};
+
+// time moves only when told to (deterministic tests/simulations)
+struct ManualClock {
+    Duration Now() const noexcept {
+        return *now;
+    }
+    void Advance(Duration d) noexcept {
+        *now += d;
+    }
+    void Set(Duration t) noexcept {
+        *now = t;
+    }
+private:
+    // copies of clock share time => wheel can hold its own copy
+    std::shared_ptr<Duration> now = std::make_shared<Duration>();
+};
+
+// Hierarchical timing wheel (Varghese & Lauck): 4 levels x 256 slots of intrusive lists,
+// so Arm() and Cancel() are O(1) and Advance() is O(1) amortized per tick + fired timers.
+// Timers further than 2^32 ticks are parked in the top level and re-cascaded.
+// All methods are thread-safe, callbacks run on Advance() caller outside of the lock.
+template<typename Clock = SteadyClock>
+struct TimerWheel {
+    struct Handle {
+        uint32_t index = nil;
+        uint32_t gen = 0;
+    };
+    explicit TimerWheel(Duration tick = std::chrono::milliseconds(1), Clock clock = {}) :
+        clock(std::move(clock)), tick(tick)
+    {
+        // tick is a divisor in Arm() and Advance()
+        if (meta_Unlikely(tick.count() <= 0)) {
+            throw std::invalid_argument("TimerWheel: tick must be positive");
+        }
+        start = this->clock.Now();
+        for (auto& level: slots) {
+            for (auto& s: level) s = nil;
+        }
+    }
+    TimerWheel(const TimerWheel&) = delete;
+    // negative duration fires on next tick
+    Handle Arm(Duration after, MoveFunc<void()> cb) {
+        if (after.count() < 0) {
+            after = Duration::zero();
+        }
+        auto ticks = uint64_t((after.count() + tick.count() - 1) / tick.count());
+        std::lock_guard lock(mut);
+        auto now = nowTick();
+        auto idx = alloc();
+        auto& n = nodes[idx];
+        n.cb = std::move(cb);
+        n.expiry = (now > current ? now : current) + (ticks ? ticks : 1);
+        insert(idx);
+        return {idx, n.gen};
+    }
+    // false if timer already fired or was cancelled
+    bool Cancel(Handle h) {
+        MoveFunc<void()> dead;
+        std::lock_guard lock(mut);
+        if (h.index >= nodes.size() || nodes[h.index].gen != h.gen || !nodes[h.index].armed) {
+            return false;
+        }
+        unlink(h.index);
+        dead = std::move(nodes[h.index].cb);
+        release(h.index);
+        return true;
+    }
+    // fire everything, that expired by Clock::Now(), returns number of fired timers
+    size_t Advance() {
+        std::vector<MoveFunc<void()>> fired;
+        {
+            std::lock_guard lock(mut);
+            auto target = nowTick();
+            if (!armed) {
+                current = target > current ? target : current;
+            }
+            while (current < target) {
+                ++current;
+                if (!(current & mask)) {
+                    cascade(1);
+                }
+                auto& head = slots[0][current & mask];
+                while (head != nil) {
+                    auto idx = head;
+                    unlink(idx);
+                    fired.push_back(std::move(nodes[idx].cb));
+                    release(idx);
+                }
+                if (!armed) {
+                    current = target;
+                }
+            }
+        }
+        for (auto& cb: fired) {
+            cb();
+        }
+        return fired.size();
+    }
+    size_t Size() const {
+        std::lock_guard lock(mut);
+        return armed;
+    }
+    Duration Tick() const noexcept {
+        return tick;
+    }
+    Clock& GetClock() noexcept {
+        return clock;
+    }
+    // pending callbacks are dropped without a call (outside of lock: they may own promises)
+    ~TimerWheel() {
+        std::vector<MoveFunc<void()>> dead;
+        std::lock_guard lock(mut);
+        for (auto& n: nodes) {
+            if (n.armed) dead.push_back(std::move(n.cb));
+        }
+    }
+private:
+    static constexpr uint32_t nil = UINT32_MAX;
+    static constexpr unsigned bits = 8;
+    static constexpr uint64_t mask = (1u << bits) - 1;
+    static constexpr unsigned levels = 4;
+    struct Node {
+        uint32_t prev = nil;
+        uint32_t next = nil;
+        uint32_t gen = 0;
+        uint8_t level = 0;
+        uint8_t slot = 0;
+        bool armed = false;
+        uint64_t expiry = 0;
+        MoveFunc<void()> cb;
+    };
+    uint64_t nowTick() const {
+        auto elapsed = clock.Now() - start;
+        return elapsed.count() > 0 ? uint64_t(elapsed.count() / tick.count()) : 0;
+    }
+    uint32_t alloc() {
+        if (freeList.empty()) {
+            nodes.emplace_back();
+            return uint32_t(nodes.size() - 1);
+        }
+        auto idx = freeList.back();
+        freeList.pop_back();
+        return idx;
+    }
+    void release(uint32_t idx) {
+        auto& n = nodes[idx];
+        n.gen++;
+        n.armed = false;
+        freeList.push_back(idx);
+    }
+    void insert(uint32_t idx) {
+        auto& n = nodes[idx];
+        auto delta = n.expiry > current ? n.expiry - current : 0;
+        unsigned level = 0;
+        while (level < levels - 1 && delta >> (bits * (level + 1))) {
+            level++;
+        }
+        // expiry == current only while cascading => slot is processed right after
+        uint64_t at = n.expiry > current ? n.expiry : current;
+        if (delta >> (bits * levels)) {
+            // too far => park at the farthest slot, will be re-cascaded
+            at = current + (uint64_t(1) << (bits * levels)) - 1;
+        }
+        auto slot = (at >> (bits * level)) & mask;
+        n.level = uint8_t(level);
+        n.slot = uint8_t(slot);
+        n.armed = true;
+        n.prev = nil;
+        n.next = slots[level][slot];
+        if (n.next != nil) nodes[n.next].prev = idx;
+        slots[level][slot] = idx;
+        armed++;
+    }
+    void unlink(uint32_t idx) {
+        auto& n = nodes[idx];
+        if (n.prev != nil) nodes[n.prev].next = n.next;
+        else slots[n.level][n.slot] = n.next;
+        if (n.next != nil) nodes[n.next].prev = n.prev;
+        n.prev = n.next = nil;
+        armed--;
+    }
+    void cascade(unsigned level) {
+        if (level >= levels) return;
+        auto slot = (current >> (bits * level)) & mask;
+        if (!slot) {
+            cascade(level + 1);
+        }
+        auto idx = std::exchange(slots[level][slot], nil);
+        while (idx != nil) {
+            auto next = nodes[idx].next;
+            armed--;
+            insert(idx);
+            idx = next;
+        }
+    }
+    mutable std::mutex mut;
+    Clock clock;
+    Duration tick;
+    Duration start;
+    uint64_t current = 0;
+    size_t armed = 0;
+    uint32_t slots[levels][1u << bits];
+    std::vector<Node> nodes;
+    std::vector<uint32_t> freeList;
+};
+
+// Drives wheel from a background thread, that wakes up every tick
+template<typename Clock = SteadyClock>
+struct TimerThread {
+    explicit TimerThread(Duration tick = std::chrono::milliseconds(1)) :
+        wheel(tick), thread([this]{
+            while (!stopping.load(std::memory_order_relaxed)) {
+                wheel.Advance();
+                std::this_thread::sleep_for(wheel.Tick());
+            }
+        })
+    {}
+    TimerWheel<Clock>& Wheel() noexcept {
+        return wheel;
+    }
+    ~TimerThread() {
+        stopping = true;
+        thread.join();
+    }
+private:
+    TimerWheel<Clock> wheel;
+    std::atomic<bool> stopping = false;
+    std::thread thread;
+};
+
+// resolved after duration. Cancel() on returned future disarms the timer
+template<typename Clock>
+Future<void> Sleep(TimerWheel<Clock>& wheel, Duration d) {
+    Promise<void> prom;
+    auto fut = prom.GetFuture();
+    FutureState<void> state = prom.PeekState();
+    auto h = wheel.Arm(d, [MV(prom)]{prom.Resolve();});
+    state->OnCancel([w = &wheel, h]{w->Cancel(h);});
+    return fut;
+}
+
+// forwards result of fut, or TimeoutError (and Cancel() upstream) if it is not ready in time
+template<typename Clock, typename T>
+Future<T> WithTimeout(TimerWheel<Clock>& wheel, Future<T> fut, Duration d) {
+    if (fut.IsReady()) {
+        return fut;
+    }
+    using Wheel = TimerWheel<Clock>;
+    struct Ctx {
+        Promise<T> out;
+        std::atomic<bool> done = false;
+        // null once timer callback is gone (fired, cancelled or dropped with the wheel)
+        std::atomic<Wheel*> wheel;
+        typename Wheel::Handle timer;
+        void Disarm() {
+            if (auto w = wheel.exchange(nullptr, std::memory_order_acq_rel))
+                w->Cancel(timer);
+        }
+    };
+    // owned by timer callback
+    struct Armed {
+        std::shared_ptr<Ctx> ctx;
+        Armed(std::shared_ptr<Ctx> ctx) noexcept : ctx(std::move(ctx)) {}
+        Armed(Armed&&) noexcept = default;
+        ~Armed() {
+            if (ctx) ctx->wheel.store(nullptr, std::memory_order_release);
+        }
+    };
+    auto ctx = std::make_shared<Ctx>();
+    auto res = ctx->out.GetFuture();
+    FutureState<T> upstream = fut.PeekState();
+    ctx->wheel = &wheel;
+    ctx->timer = wheel.Arm(d, [armed = Armed(ctx), upstream]{
+        auto& ctx = armed.ctx;
+        if (ctx->done.exchange(true, std::memory_order_acq_rel))
+            return;
+        ctx->out.Resolve(TimeoutError{});
+        upstream->Cancel();
+    });
+    // weak: ctx owns out => strong ref would keep ctx alive forever,
+    // if nothing resolves it (e.g. wheel is destroyed with timer pending)
+    ctx->out.OnCancel([weak = std::weak_ptr<Ctx>(ctx), upstream]{
+        auto ctx = weak.lock();
+        if (!ctx || ctx->done.exchange(true, std::memory_order_acq_rel))
+            return;
+        ctx->Disarm();
+        upstream->Cancel();
+    });
+    fut.Then([ctx](FutureResult<T> r){
+        if (ctx->done.exchange(true, std::memory_order_acq_rel))
+            return;
+        ctx->Disarm();
+        ctx->out.Resolve(std::move(r));
+    });
+    return res;
+}
+
+} //fut
+
+#endif //FUT_TIMER_HPP
@@ -0,0 +1,150 @@
+#ifndef MEMBUFF_CHAIN_HPP
+#define MEMBUFF_CHAIN_HPP
+
+#include <mutex>
+#include <vector>
+#include "membuff.hpp"
+
+#if __has_include(<sys/uio.h>)
+#include <sys/uio.h>
+#endif
+
+namespace membuff
+{
+
+#if __has_include(<sys/uio.h>)
+using IoVec = ::iovec;
+#else
+struct IoVec {
+    void* iov_base;
+    size_t iov_len;
+};
+#endif
+
+// Thread-safe cache of fixed-size segments, shared by many ChainOut-s.
+// Must outlive all chains, that use it
+struct SegmentPool {
+    explicit SegmentPool(size_t segmentSize = 16384, size_t maxCached = 1024) :
+        segmentSize(segmentSize), maxCached(maxCached)
+    {}
+    SegmentPool(const SegmentPool&) = delete;
+    char* Acquire() {
+        {
+            std::lock_guard lock(mut);
+            if (!free.empty()) {
+                auto seg = free.back();
+                free.pop_back();
+                return seg;
+            }
+        }
+        return new char[segmentSize];
+    }
+    void Release(char* seg) noexcept {
+        {
+            std::lock_guard lock(mut);
+            if (free.size() < maxCached) {
+                free.push_back(seg);
+                return;
+            }
+        }
+        delete[] seg;
+    }
+    size_t SegmentSize() const noexcept {
+        return segmentSize;
+    }
+    ~SegmentPool() {
+        for (auto seg: free) delete[] seg;
+    }
+private:
+    std::mutex mut;
+    std::vector<char*> free;
+    size_t segmentSize;
+    size_t maxCached;
+};
+
+// Owns filled segments, returns them to pool on destruction.
+// Data() can be passed straight to writev()/sendmsg()
+struct Chain {
+    explicit Chain(SegmentPool* pool = nullptr) noexcept : pool(pool) {}
+    Chain(Chain&& o) noexcept : pool(o.pool), vecs(std::move(o.vecs)) {
+        o.vecs.clear();
+    }
+    Chain& operator=(Chain&& o) noexcept {
+        std::swap(pool, o.pool);
+        std::swap(vecs, o.vecs);
+        return *this;
+    }
+    const IoVec* Data() const noexcept {
+        return vecs.data();
+    }
+    size_t Count() const noexcept {
+        return vecs.size();
+    }
+    size_t TotalSize() const noexcept {
+        size_t res = 0;
+        for (auto& v: vecs) res += v.iov_len;
+        return res;
+    }
+    ~Chain() {
+        for (auto& v: vecs) {
+            pool->Release(static_cast<char*>(v.iov_base));
+        }
+    }
+private:
+    friend struct ChainOut;
+    SegmentPool* pool;
+    std::vector<IoVec> vecs;
+};
+
+// Out over a list of pool segments: Grow() never relocates written data, it seals current
+// segment and appends next one. Reserve() can not give more than one segment of room
+struct ChainOut final : Out
+{
+    explicit ChainOut(SegmentPool& pool) : chain(&pool) {
+        next();
+    }
+    void Grow(size_t) override {
+        seal();
+        written += ptr;
+        next();
+    }
+    // bytes written so far
+    size_t Size() const noexcept {
+        return written + ptr;
+    }
+    // valid until next Write()
+    const std::vector<IoVec>& IoVecs() noexcept {
+        seal();
+        return chain.vecs;
+    }
+    // hand written data off (e.g. to async send), out starts over with a fresh segment
+    Chain Detach() {
+        seal();
+        if (!chain.vecs.back().iov_len) {
+            chain.pool->Release(buffer);
+            chain.vecs.pop_back();
+        }
+        Chain res(chain.pool);
+        std::swap(res, chain);
+        written = 0;
+        next();
+        return res;
+    }
+private:
+    void seal() noexcept {
+        chain.vecs.back().iov_len = ptr;
+    }
+    void next() {
+        auto seg = chain.pool->Acquire();
+        chain.vecs.push_back({seg, 0});
+        buffer = seg;
+        ptr = 0;
+        capacity = chain.pool->SegmentSize();
+    }
+    Chain chain;
+    size_t written = 0;
+};
+
+} //membuff
+
+#endif //MEMBUFF_CHAIN_HPP
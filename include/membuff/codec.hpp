@@ -0,0 +1,232 @@
+#ifndef MEMBUFF_CODEC_HPP
+#define MEMBUFF_CODEC_HPP
+
+#include <string>
+#include <cstdint>
+#include <type_traits>
+#include "membuff.hpp"
+
+namespace membuff
+{
+
+// Encoding layer over BasicOut/BasicIn (works with both virtual and static backends).
+// Encoders write straight into buffer when there is room, byte-by-byte only at buffer edge.
+// Decoders return false on failure: LastError is EndOfInput/errno, or BadEncoding
+constexpr long BadEncoding = -2;
+
+namespace det {
+
+template<size_t N> struct UintOf;
+template<> struct UintOf<1> {using type = uint8_t;};
+template<> struct UintOf<2> {using type = uint16_t;};
+template<> struct UintOf<4> {using type = uint32_t;};
+template<> struct UintOf<8> {using type = uint64_t;};
+
+template<typename T>
+using uint_of = typename UintOf<sizeof(T)>::type;
+
+template<typename T>
+constexpr bool is_fixed = std::is_arithmetic_v<T> && !std::is_same_v<T, bool> && sizeof(T) <= 8;
+
+template<typename T>
+uint_of<T> toBits(T value) noexcept {
+    uint_of<T> bits;
+    ::memcpy(&bits, &value, sizeof(T));
+    return bits;
+}
+
+template<typename T>
+T fromBits(uint_of<T> bits) noexcept {
+    T value;
+    ::memcpy(&value, &bits, sizeof(T));
+    return value;
+}
+
+// shift-based => independent of host byte order, compilers fold it into (bswap +) mov
+template<bool big, typename U>
+void storeBytes(char* out, U bits) noexcept {
+    for (size_t i = 0; i < sizeof(U); ++i) {
+        out[big ? sizeof(U) - 1 - i : i] = char(uint8_t(bits >> (8 * i)));
+    }
+}
+
+template<bool big, typename U>
+U loadBytes(const char* in) noexcept {
+    U bits = 0;
+    for (size_t i = 0; i < sizeof(U); ++i) {
+        bits |= U(uint8_t(in[big ? sizeof(U) - 1 - i : i])) << (8 * i);
+    }
+    return bits;
+}
+
+template<bool big, typename T, typename B>
+void writeFixed(BasicOut<B>& out, T value) {
+    auto bits = toBits(value);
+    if (meta_Likely(out.capacity - out.ptr > sizeof(T))) {
+        storeBytes<big>(out.buffer + out.ptr, bits);
+        out.ptr += sizeof(T);
+    } else {
+        char tmp[sizeof(T)];
+        storeBytes<big>(tmp, bits);
+        out.Write(tmp, sizeof(T));
+    }
+}
+
+template<bool big, typename T, typename B>
+bool readFixed(BasicIn<B>& in, T& value) {
+    if (meta_Likely(in.Available() >= sizeof(T))) {
+        value = fromBits<T>(loadBytes<big, uint_of<T>>(in.buffer + in.ptr));
+        in.ptr += sizeof(T);
+        return true;
+    }
+    char tmp[sizeof(T)];
+    in.LastError = 0;
+    if (in.Read(tmp, sizeof(T)) != sizeof(T)) {
+        if (!in.LastError) in.LastError = Common::EndOfInput;
+        return false;
+    }
+    value = fromBits<T>(loadBytes<big, uint_of<T>>(tmp));
+    return true;
+}
+
+} //det
+
+constexpr size_t MaxVarintSize = 10;
+
+constexpr uint64_t ZigZag(int64_t value) noexcept {
+    return (uint64_t(value) << 1) ^ uint64_t(value >> 63);
+}
+
+constexpr int64_t UnZigZag(uint64_t value) noexcept {
+    return int64_t(value >> 1) ^ -int64_t(value & 1);
+}
+
+// LEB128
+template<typename B>
+void WriteVarint(BasicOut<B>& out, uint64_t value) {
+    if (meta_Likely(out.capacity - out.ptr > MaxVarintSize)) {
+        auto p = out.buffer + out.ptr;
+        while (value >= 0x80) {
+            *p++ = char(uint8_t(value) | 0x80);
+            value >>= 7;
+        }
+        *p++ = char(value);
+        out.ptr = size_t(p - out.buffer);
+        return;
+    }
+    while (value >= 0x80) {
+        out.Write(char(uint8_t(value) | 0x80));
+        value >>= 7;
+    }
+    out.Write(char(value));
+}
+
+template<typename B>
+bool ReadVarint(BasicIn<B>& in, uint64_t& value) {
+    uint64_t res = 0;
+    if (meta_Likely(in.Available() >= MaxVarintSize)) {
+        auto p = in.buffer + in.ptr;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            auto byte = uint8_t(*p++);
+            if (meta_Unlikely(shift == 63 && byte > 1)) {
+                break; // 10th byte has room for one bit only
+            }
+            res |= uint64_t(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                in.ptr = size_t(p - in.buffer);
+                value = res;
+                return true;
+            }
+        }
+        in.LastError = BadEncoding;
+        return false;
+    }
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        auto byte = uint8_t(in.ReadByte());
+        if (meta_Unlikely(in.LastError)) {
+            return false;
+        }
+        if (meta_Unlikely(shift == 63 && byte > 1)) {
+            break;
+        }
+        res |= uint64_t(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            value = res;
+            return true;
+        }
+    }
+    in.LastError = BadEncoding;
+    return false;
+}
+
+template<typename B>
+void WriteSVarint(BasicOut<B>& out, int64_t value) {
+    WriteVarint(out, ZigZag(value));
+}
+
+template<typename B>
+bool ReadSVarint(BasicIn<B>& in, int64_t& value) {
+    uint64_t raw;
+    if (!ReadVarint(in, raw)) return false;
+    value = UnZigZag(raw);
+    return true;
+}
+
+// Fixed-width integers and floats (IEEE bits)
+
+template<typename T, typename B, std::enable_if_t<det::is_fixed<T>, int> = 0>
+void WriteLE(BasicOut<B>& out, T value) {
+    det::writeFixed<false>(out, value);
+}
+
+template<typename T, typename B, std::enable_if_t<det::is_fixed<T>, int> = 0>
+void WriteBE(BasicOut<B>& out, T value) {
+    det::writeFixed<true>(out, value);
+}
+
+template<typename T, typename B, std::enable_if_t<det::is_fixed<T>, int> = 0>
+bool ReadLE(BasicIn<B>& in, T& value) {
+    return det::readFixed<false>(in, value);
+}
+
+template<typename T, typename B, std::enable_if_t<det::is_fixed<T>, int> = 0>
+bool ReadBE(BasicIn<B>& in, T& value) {
+    return det::readFixed<true>(in, value);
+}
+
+// Varint length + bytes
+
+template<typename B>
+void WriteString(BasicOut<B>& out, std::string_view str) {
+    WriteVarint(out, str.size());
+    out.Write(str.data(), str.size());
+}
+
+// zero-copy (see BasicIn::Borrow()), view is valid until next read
+template<typename B>
+bool BorrowString(BasicIn<B>& in, std::string_view& str, size_t maxSize = SIZE_MAX) {
+    uint64_t size;
+    if (!ReadVarint(in, size)) return false;
+    if (meta_Unlikely(size > maxSize)) {
+        in.LastError = BadEncoding;
+        return false;
+    }
+    str = in.Borrow(size_t(size));
+    if (meta_Unlikely(str.size() != size)) {
+        if (!in.LastError) in.LastError = Common::EndOfInput;
+        return false;
+    }
+    return true;
+}
+
+template<typename B>
+bool ReadString(BasicIn<B>& in, std::string& str, size_t maxSize = SIZE_MAX) {
+    std::string_view view;
+    if (!BorrowString(in, view, maxSize)) return false;
+    str.assign(view.data(), view.size());
+    return true;
+}
+
+} //membuff
+
+#endif //MEMBUFF_CODEC_HPP
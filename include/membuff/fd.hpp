@@ -0,0 +1,189 @@
+#ifndef MEMBUFF_FD_HPP
+#define MEMBUFF_FD_HPP
+
+#include <memory>
+#include <cerrno>
+#include <climits>
+#include <unistd.h>
+#include "chain.hpp"
+
+namespace membuff
+{
+
+namespace det {
+
+#ifdef IOV_MAX
+constexpr size_t maxIoVecs = IOV_MAX;
+#else
+constexpr size_t maxIoVecs = 1024;
+#endif
+
+// writes everything (handles partial writes, vecs are consumed). Returns 0 or errno
+inline long writeAll(int fd, IoVec* vecs, size_t count) noexcept {
+    while (count) {
+        auto n = ::writev(fd, vecs, int(count < maxIoVecs ? count : maxIoVecs));
+        if (meta_Unlikely(n < 0)) {
+            if (errno == EINTR) continue;
+            return errno;
+        }
+        auto done = size_t(n);
+        while (count && done >= vecs->iov_len) {
+            done -= vecs->iov_len;
+            vecs++;
+            count--;
+        }
+        if (count) {
+            vecs->iov_base = static_cast<char*>(vecs->iov_base) + done;
+            vecs->iov_len -= done;
+        }
+    }
+    return 0;
+}
+
+// single readv(), 0 bytes means error (EndOfInput or errno)
+inline size_t readSome(int fd, IoVec* vecs, size_t count, long& err) noexcept {
+    for (;;) {
+        auto n = ::readv(fd, vecs, int(count));
+        if (meta_Likely(n > 0)) {
+            err = 0;
+            return size_t(n);
+        }
+        if (n == 0) {
+            err = Common::EndOfInput;
+            return 0;
+        }
+        if (errno != EINTR) {
+            err = errno;
+            return 0;
+        }
+    }
+}
+
+} //det
+
+// Buffered reader over a (blocking) file descriptor. Does not own fd.
+// LastError is EndOfInput at end of file, errno on failure
+struct FdIn final : In
+{
+    explicit FdIn(int fd, size_t bufferSize = 65536) :
+        fd(fd), bufferSize(bufferSize), storage(new char[bufferSize])
+    {
+        buffer = storage.get();
+    }
+    FdIn(const FdIn&) = delete;
+    void Refill(size_t) override {
+        auto data = storage.get();
+        if (ptr) {
+            ::memmove(data, data + ptr, capacity - ptr);
+            capacity -= ptr;
+            ptr = 0;
+        }
+        if (capacity == bufferSize) {
+            LastError = 0;
+            return;
+        }
+        IoVec vec{data + capacity, bufferSize - capacity};
+        capacity += det::readSome(fd, &vec, 1, LastError);
+    }
+    // reads exactly (size) bytes unless input ends or fails. Big reads go straight into buff,
+    // the same readv() tops up internal buffer with whatever comes after
+    size_t ReadFull(void* buff, size_t size) {
+        auto out = static_cast<char*>(buff);
+        auto done = Available() < size ? Available() : size;
+        ::memcpy(out, buffer + ptr, done);
+        ptr += done;
+        LastError = 0;
+        if (done == size) {
+            return done;
+        }
+        ptr = capacity = 0;
+        while (done < size) {
+            IoVec vecs[2] = {{out + done, size - done}, {storage.get(), bufferSize}};
+            auto n = det::readSome(fd, vecs, 2, LastError);
+            if (meta_Unlikely(!n)) {
+                break;
+            }
+            if (n > size - done) {
+                capacity = n - (size - done);
+                done = size;
+            } else {
+                done += n;
+            }
+        }
+        return done;
+    }
+    int Fd() const noexcept {
+        return fd;
+    }
+private:
+    int fd;
+    size_t bufferSize;
+    std::unique_ptr<char[]> storage;
+};
+
+// Buffered writer over a (blocking) file descriptor. Does not own fd, flushes on destruction.
+// On failure LastError is errno and buffered bytes are dropped
+struct FdOut final : Out
+{
+    explicit FdOut(int fd, size_t bufferSize = 65536) :
+        fd(fd), storage(new char[bufferSize])
+    {
+        buffer = storage.get();
+        capacity = bufferSize;
+    }
+    FdOut(const FdOut&) = delete;
+    void Grow(size_t) override {
+        Flush();
+    }
+    bool Flush() {
+        IoVec vec{buffer, ptr};
+        return submit(&vec, ptr ? 1 : 0);
+    }
+    // small payloads are buffered, big ones go out together with buffer in a single writev()
+    bool WriteV(const IoVec* vecs, size_t count) {
+        size_t total = 0;
+        for (size_t i = 0; i < count; ++i) {
+            total += vecs[i].iov_len;
+        }
+        if (total < capacity - ptr) {
+            for (size_t i = 0; i < count; ++i) {
+                ::memcpy(buffer + ptr, vecs[i].iov_base, vecs[i].iov_len);
+                ptr += vecs[i].iov_len;
+            }
+            LastError = 0;
+            return true;
+        }
+        scratch.clear();
+        if (ptr) {
+            scratch.push_back({buffer, ptr});
+        }
+        scratch.insert(scratch.end(), vecs, vecs + count);
+        return submit(scratch.data(), scratch.size());
+    }
+    bool WriteV(const Chain& chain) {
+        return WriteV(chain.Data(), chain.Count());
+    }
+    bool WriteDirect(const void* data, size_t size) {
+        IoVec vec{const_cast<void*>(data), size};
+        return WriteV(&vec, 1);
+    }
+    int Fd() const noexcept {
+        return fd;
+    }
+    ~FdOut() {
+        Flush();
+    }
+private:
+    bool submit(IoVec* vecs, size_t count) {
+        ptr = 0;
+        LastError = det::writeAll(fd, vecs, count);
+        return !LastError;
+    }
+    int fd;
+    std::unique_ptr<char[]> storage;
+    std::vector<IoVec> scratch;
+};
+
+} //membuff
+
+#endif //MEMBUFF_FD_HPP
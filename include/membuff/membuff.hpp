@@ -12,12 +12,19 @@ namespace membuff
 {
 
 struct Common {
+    // LastError for exhausted input. Backends otherwise store positive errno values
+    static constexpr long EndOfInput = -1;
+
     size_t ptr = {};
     size_t capacity = {};
     long LastError = {};
 };
 
-struct In : Common
+// Statically dispatched reader: Backend provides Refill(size_t amountHint), that
+// must keep unread bytes [ptr, capacity) readable (may move them to start of buffer).
+// Generic decoders should take BasicIn<B>& => concrete backends inline into them
+template<typename Backend>
+struct BasicIn : Common
 {
     const char* buffer = {};
 
@@ -25,11 +32,26 @@ struct In : Common
     char ReadByte(size_t growAmount = 0);
     size_t Read(char* buff, size_t size, size_t growAmount = 0);
     size_t Read(void* buff, size_t size, size_t growAmount = 0);
-    virtual void Refill(size_t amountHint) = 0;
-    virtual ~In() = default;
+    // Zero-copy access: views are valid until next call on this In.
+    // Up to (size) bytes without consuming them. Shorter at end of input or
+    // if backend can not hold (size) bytes contiguously
+    std::string_view Peek(size_t size);
+    // consumes (size) bytes (less only at end of input/error). Copies into
+    // internal scratch only if bytes straddle a refill, that can not keep them contiguous
+    std::string_view Borrow(size_t size);
+    // consumes up to (size) bytes without copying, returns how many were skipped
+    size_t Skip(size_t size);
+private:
+    Backend& backend() noexcept {
+        return static_cast<Backend&>(*this);
+    }
+    bool fill(size_t size);
+    std::string scratch;
 };
 
-struct Out : Common
+// Statically dispatched writer: Backend provides Grow(size_t amountHint)
+template<typename Backend>
+struct BasicOut : Common
 {
     char* buffer = {};
 
@@ -40,83 +62,174 @@ struct Out : Common
     void Write(uint8_t byte, size_t growAmount = 0) {
         return Write(char(byte), growAmount);
     }
+    // make sure next (size) bytes can be written without Grow()
+    void Reserve(size_t size);
+private:
+    Backend& backend() noexcept {
+        return static_cast<Backend&>(*this);
+    }
+};
+
+// Type-erased reader/writer: same API, Refill()/Grow() are virtual
+
+struct In : BasicIn<In>
+{
+    virtual void Refill(size_t amountHint) = 0;
+    virtual ~In() = default;
+};
+
+struct Out : BasicOut<Out>
+{
     virtual void Grow(size_t amountHint) = 0;
     virtual ~Out() = default;
 };
 
-template<typename String = std::string>
-struct StringOut final: Out
+// Growth policies: Next(current, required) -> new size (>= required)
+
+template<size_t Num = 2, size_t Den = 1>
+struct GrowGeometric {
+    static_assert(Num > Den);
+    size_t Next(size_t current, size_t required) const noexcept {
+        auto next = current / Den * Num;
+        return next > required ? next : required;
+    }
+};
+
+template<size_t Chunk = 4096>
+struct GrowChunked {
+    static_assert(Chunk > 0);
+    size_t Next(size_t, size_t required) const noexcept {
+        return (required + Chunk - 1) / Chunk * Chunk;
+    }
+};
+
+// geometric, but never more than Cap bytes at once (big buffers)
+template<size_t Cap = size_t(1) << 20, typename Inner = GrowGeometric<>>
+struct GrowCapped {
+    size_t Next(size_t current, size_t required) const noexcept {
+        auto next = inner.Next(current, required);
+        if (next - current > Cap) next = current + Cap;
+        return next > required ? next : required;
+    }
+    Inner inner = {};
+};
+
+namespace det {
+
+template<typename Base, typename String, typename Policy>
+struct StringOutImpl : Base
 {
     using size_type = typename String::size_type;
     String Consume() noexcept {
-        str.resize(size_type(ptr));
+        str.resize(size_type(this->ptr));
         return std::move(str);
     }
-    void Grow(size_t amount) override {
-        auto newStr = str;
-        newStr.resize(str.size() + size_type(amount));
-        str.swap(newStr);
-        buffer = reinterpret_cast<char*>(str.data());
-        capacity = size_t(str.size());
+    // resized in place, as often as policy allows. Cut to the written part
+    // first => reallocation copies only bytes, that were actually written
+    void Grow(size_t amount) {
+        auto current = size_t(str.size());
+        str.resize(size_type(this->ptr));
+        str.resize(size_type(policy.Next(current, current + amount)));
+        this->buffer = reinterpret_cast<char*>(str.data());
+        this->capacity = size_t(str.size());
     }
-    StringOut(size_t startSize = 512) {
+    StringOutImpl(size_t startSize, Policy policy) : policy(policy) {
         str.resize(size_type(startSize));
-        buffer = reinterpret_cast<char*>(str.data());
-        capacity = size_t(str.size());
+        this->buffer = reinterpret_cast<char*>(str.data());
+        this->capacity = size_t(str.size());
     }
 protected:
     String str;
+    Policy policy;
 };
 
-inline void Out::Write(const char *data, size_t size, size_t growAmount)
+} //det
+
+template<typename String = std::string, typename Policy = GrowGeometric<>>
+struct StringOut final: det::StringOutImpl<Out, String, Policy>
+{
+    StringOut(size_t startSize = 512, Policy policy = {}) :
+        det::StringOutImpl<Out, String, Policy>(startSize, policy)
+    {}
+};
+
+// StringOut without virtual dispatch (not convertible to Out&)
+template<typename String = std::string, typename Policy = GrowGeometric<>>
+struct StaticStringOut final:
+    det::StringOutImpl<BasicOut<StaticStringOut<String, Policy>>, String, Policy>
+{
+    StaticStringOut(size_t startSize = 512, Policy policy = {}) :
+        det::StringOutImpl<BasicOut<StaticStringOut>, String, Policy>(startSize, policy)
+    {}
+};
+
+template<typename Backend>
+inline void BasicOut<Backend>::Write(const char *data, size_t size, size_t growAmount)
 {
     if (ptr + size >= capacity) {
-        do {
-            Grow(growAmount ? growAmount : capacity);
-            if (meta_Unlikely(LastError)) {
-                return;
-            }
+        // fill current window first, ptr < capacity holds after return (as for Write(char))
+        for (;;) {
             auto left = capacity - ptr;
             auto min = std::min meta_NO_MACRO (size, left);
             ::memcpy(buffer + ptr, data, min);
             size -= min;
             ptr += min;
             data += min;
-        } while (size);
+            if (ptr < capacity) {
+                return;
+            }
+            backend().Grow(growAmount ? growAmount : capacity);
+            if (meta_Unlikely(LastError) || !size) {
+                return;
+            }
+        }
     } else {
         ::memcpy(buffer + ptr, data, size);
         ptr += size;
     }
 }
 
-inline void Out::Write(const void *data, size_t size, size_t growAmount)
+template<typename Backend>
+inline void BasicOut<Backend>::Write(const void *data, size_t size, size_t growAmount)
 {
     Write(static_cast<const char*>(data), size, growAmount);
 }
 
-inline void Out::Write(std::string_view data, size_t growAmount)
+template<typename Backend>
+inline void BasicOut<Backend>::Write(std::string_view data, size_t growAmount)
 {
     return Write(data.data(), data.size(), growAmount);
 }
 
-inline void Out::Write(char byte, size_t growAmount) {
+template<typename Backend>
+inline void BasicOut<Backend>::Write(char byte, size_t growAmount) {
     LastError = 0;
     buffer[ptr++] = byte;
     if (meta_Unlikely(ptr == capacity)) {
-        Grow(growAmount ? growAmount : capacity);
+        backend().Grow(growAmount ? growAmount : capacity);
+    }
+}
+
+template<typename Backend>
+inline void BasicOut<Backend>::Reserve(size_t size)
+{
+    if (ptr + size >= capacity) {
+        backend().Grow(ptr + size + 1 - capacity);
     }
 }
 
-inline size_t In::Available() const noexcept
+template<typename Backend>
+inline size_t BasicIn<Backend>::Available() const noexcept
 {
     return capacity - ptr;
 }
 
-inline char In::ReadByte(size_t growAmount)
+template<typename Backend>
+inline char BasicIn<Backend>::ReadByte(size_t growAmount)
 {
     LastError = 0;
     if (meta_Unlikely(ptr == capacity)) {
-        Refill(growAmount ? growAmount : capacity);
+        backend().Refill(growAmount ? growAmount : capacity);
         if (meta_Unlikely(LastError)) {
             return {};
         }
@@ -125,25 +238,30 @@ inline char In::ReadByte(size_t growAmount)
     return res;
 }
 
-inline size_t In::Read(char *buff, size_t size, size_t growAmount)
+template<typename Backend>
+inline size_t BasicIn<Backend>::Read(char *buff, size_t size, size_t growAmount)
 {
-    if (ptr + size >= capacity) {
+    if (ptr + size > capacity) {
+        // take buffered bytes first, Refill() only when more are needed (it may block)
         size_t read = 0;
-        do {
-            Refill(growAmount ? growAmount : capacity);
-            if (meta_Unlikely(LastError)) {
-                auto left = Available();
-                ::memcpy(buff + read, buffer + ptr, left);
-                return read + left;
-            }
+        for (;;) {
             auto left = capacity - ptr;
             auto min = std::min meta_NO_MACRO (size, left);
             ::memcpy(buff + read, buffer + ptr, min);
             size -= min;
             ptr += min;
             read += min;
-        } while (size);
-        return read;
+            if (!size) {
+                return read;
+            }
+            backend().Refill(growAmount ? growAmount : capacity);
+            if (meta_Unlikely(LastError)) {
+                auto rest = std::min meta_NO_MACRO (size, Available());
+                ::memcpy(buff + read, buffer + ptr, rest);
+                ptr += rest;
+                return read + rest;
+            }
+        }
     } else {
         ::memcpy(buff, buffer + ptr, size);
         ptr += size;
@@ -151,11 +269,78 @@ inline size_t In::Read(char *buff, size_t size, size_t growAmount)
     }
 }
 
-inline size_t In::Read(void *buff, size_t size, size_t growAmount)
+template<typename Backend>
+inline size_t BasicIn<Backend>::Read(void *buff, size_t size, size_t growAmount)
 {
     return Read(static_cast<char*>(buff), size, growAmount);
 }
 
+template<typename Backend>
+inline bool BasicIn<Backend>::fill(size_t size)
+{
+    LastError = 0;
+    while (Available() < size) {
+        auto before = Available();
+        backend().Refill(size - before);
+        if (LastError || Available() <= before) {
+            return Available() >= size;
+        }
+    }
+    return true;
+}
+
+template<typename Backend>
+inline std::string_view BasicIn<Backend>::Peek(size_t size)
+{
+    if (meta_Unlikely(Available() < size)) {
+        fill(size);
+        size = std::min meta_NO_MACRO (size, Available());
+    }
+    return {buffer + ptr, size};
+}
+
+template<typename Backend>
+inline std::string_view BasicIn<Backend>::Borrow(size_t size)
+{
+    if (meta_Likely(Available() >= size) || fill(size) || LastError) {
+        size = std::min meta_NO_MACRO (size, Available());
+        std::string_view res{buffer + ptr, size};
+        ptr += size;
+        return res;
+    }
+    scratch.assign(buffer + ptr, Available());
+    ptr = capacity;
+    while (scratch.size() < size) {
+        backend().Refill(size - scratch.size());
+        auto min = std::min meta_NO_MACRO (size - scratch.size(), Available());
+        scratch.append(buffer + ptr, min);
+        ptr += min;
+        if (meta_Unlikely(LastError)) {
+            break;
+        }
+    }
+    return scratch;
+}
+
+template<typename Backend>
+inline size_t BasicIn<Backend>::Skip(size_t size)
+{
+    LastError = 0;
+    size_t skipped = 0;
+    while (skipped < size) {
+        if (ptr == capacity) {
+            backend().Refill(size - skipped);
+            if (meta_Unlikely(ptr == capacity)) {
+                break;
+            }
+        }
+        auto min = std::min meta_NO_MACRO (size - skipped, Available());
+        ptr += min;
+        skipped += min;
+    }
+    return skipped;
+}
+
 } //jv
 
 #endif //MEMBUFF_HPP
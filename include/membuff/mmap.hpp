@@ -0,0 +1,97 @@
+#ifndef MEMBUFF_MMAP_HPP
+#define MEMBUFF_MMAP_HPP
+
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "membuff.hpp"
+
+namespace membuff
+{
+
+// Zero-copy reader over a memory-mapped file. Does not own fd.
+// window == 0 maps whole file at once, otherwise a sliding window of (window) bytes
+// is mapped and Refill() remaps it forward, so multi-GB files do not eat address space.
+// LastError is EndOfInput at end of file, errno on failure
+struct MmapIn final : In
+{
+    explicit MmapIn(int fd, size_t window = size_t(64) << 20) : fd(fd) {
+        struct stat st;
+        if (::fstat(fd, &st) < 0) {
+            LastError = errno;
+            return;
+        }
+        fileSize = size_t(st.st_size);
+        auto page = size_t(::sysconf(_SC_PAGESIZE));
+        this->window = window ? (window + page - 1) / page * page : fileSize;
+        if (this->window < 2 * page) this->window = 2 * page;
+        pageSize = page;
+        mapAt(0);
+    }
+    MmapIn(const MmapIn&) = delete;
+    void Refill(size_t) override {
+        auto pos = offset + ptr;
+        if (meta_Unlikely(offset + capacity == fileSize)) {
+            LastError = EndOfInput;
+            return;
+        }
+        // keep unread tail: next window starts at its page
+        auto next = pos / pageSize * pageSize;
+        mapAt(next);
+        ptr = pos - next;
+    }
+    // absolute position in file
+    size_t Offset() const noexcept {
+        return offset + ptr;
+    }
+    size_t FileSize() const noexcept {
+        return fileSize;
+    }
+    ~MmapIn() {
+        unmap();
+    }
+private:
+    void mapAt(size_t at) {
+        unmap();
+        offset = at;
+        ptr = capacity = 0;
+        auto len = fileSize - at < window ? fileSize - at : window;
+        if (!len) {
+            LastError = EndOfInput;
+            return;
+        }
+        auto map = ::mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, off_t(at));
+        if (meta_Unlikely(map == MAP_FAILED)) {
+            LastError = errno;
+            return;
+        }
+        ::madvise(map, len, MADV_SEQUENTIAL);
+        ::madvise(map, len, MADV_WILLNEED);
+#ifdef POSIX_FADV_WILLNEED
+        // start read-ahead of the next window while this one is consumed
+        if (at + len < fileSize) {
+            ::posix_fadvise(fd, off_t(at + len), off_t(window), POSIX_FADV_WILLNEED);
+        }
+#endif
+        buffer = static_cast<const char*>(map);
+        capacity = len;
+        LastError = 0;
+    }
+    void unmap() noexcept {
+        if (buffer) {
+            ::munmap(const_cast<char*>(buffer), capacity);
+            buffer = nullptr;
+        }
+    }
+    int fd;
+    size_t fileSize = 0;
+    size_t window = 0;
+    size_t pageSize = 4096;
+    size_t offset = 0;
+};
+
+} //membuff
+
+#endif //MEMBUFF_MMAP_HPP
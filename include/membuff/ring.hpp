@@ -0,0 +1,241 @@
+#ifndef MEMBUFF_RING_HPP
+#define MEMBUFF_RING_HPP
+
+#include <new>
+#include <atomic>
+#include <memory>
+#include <chrono>
+#include <thread>
+#include <cerrno>
+#include <stdexcept>
+#include <cstdint>
+#include "membuff.hpp"
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace membuff
+{
+
+namespace det {
+
+// spin => yield => sleep, waits are expected to be short on a busy channel
+struct Backoff {
+    void Wait() noexcept {
+        if (step < 64) {
+#if defined(__SSE2__)
+            _mm_pause();
+#endif
+        } else if (step < 128) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+        step++;
+    }
+    unsigned step = 0;
+};
+
+} //det
+
+// Single-producer single-consumer byte ring. Indices are free-running and live in
+// separate cache lines, each side also caches the other's index to avoid ping-pong.
+// Plain data (no pointers inside) => may be placed into shared memory between processes
+struct SpscRing {
+    static_assert(std::atomic<uint64_t>::is_always_lock_free);
+    static constexpr size_t cacheLine = 64;
+
+    struct Header {
+        alignas(cacheLine) std::atomic<uint64_t> head = 0; // consumed
+        alignas(cacheLine) std::atomic<uint64_t> tail = 0; // committed
+        alignas(cacheLine) std::atomic<bool> writerClosed = false;
+        std::atomic<bool> readerClosed = false;
+        uint64_t size = 0;
+    };
+    static constexpr size_t RequiredMemory(size_t size) noexcept {
+        return sizeof(Header) + size;
+    }
+    // owning, size is rounded up to a power of 2
+    explicit SpscRing(size_t size = 1 << 20) {
+        size = roundPow2(size);
+        owned.reset(new (std::align_val_t(cacheLine)) char[RequiredMemory(size)]);
+        attach(owned.get(), size, true);
+    }
+    // over external (e.g. shared) memory of RequiredMemory(size) bytes, aligned to cacheLine.
+    // Exactly one side must pass init = true, before other one attaches
+    SpscRing(void* memory, size_t size, bool init) {
+        if (size & (size - 1)) {
+            throw std::invalid_argument("SpscRing: size must be a power of 2");
+        }
+        attach(static_cast<char*>(memory), size, init);
+    }
+    SpscRing(const SpscRing&) = delete;
+    size_t Size() const noexcept {
+        return size_t(hdr->size);
+    }
+private:
+    friend struct RingOut;
+    friend struct RingIn;
+    struct AlignedDelete {
+        void operator()(char* p) const noexcept {
+            ::operator delete[](p, std::align_val_t(cacheLine));
+        }
+    };
+    static size_t roundPow2(size_t size) noexcept {
+        size_t res = 64;
+        while (res < size) res <<= 1;
+        return res;
+    }
+    void attach(char* memory, size_t size, bool init) {
+        if (init) {
+            hdr = new (memory) Header;
+            hdr->size = size;
+        } else {
+            hdr = reinterpret_cast<Header*>(memory);
+            if (hdr->size != size) {
+                throw std::invalid_argument("SpscRing: size mismatch");
+            }
+        }
+        data = memory + sizeof(Header);
+        mask = size - 1;
+    }
+    std::unique_ptr<char[], AlignedDelete> owned;
+    Header* hdr;
+    char* data;
+    uint64_t mask;
+};
+
+// Producer side. Bytes become visible to RingIn on Grow()/Flush() => Flush() after each message.
+// Both wait for free space, LastError is EPIPE (and bytes are dropped) once reader is closed
+struct RingOut final : Out
+{
+    explicit RingOut(SpscRing& ring) : ring(ring), hdr(*ring.hdr) {
+        tail = hdr.tail.load(std::memory_order_relaxed);
+        Flush();
+    }
+    RingOut(const RingOut&) = delete;
+    void Grow(size_t) override {
+        Flush();
+    }
+    // publish written bytes, waits only if ring is full
+    void Flush() noexcept {
+        if (meta_Unlikely(hdr.readerClosed.load(std::memory_order_acquire))) {
+            dropAll();
+            return;
+        }
+        publish();
+        headCache = hdr.head.load(std::memory_order_acquire);
+        det::Backoff backoff;
+        while (tail - headCache == hdr.size) {
+            if (meta_Unlikely(hdr.readerClosed.load(std::memory_order_acquire))) {
+                dropAll();
+                return;
+            }
+            backoff.Wait();
+            headCache = hdr.head.load(std::memory_order_acquire);
+        }
+        LastError = 0;
+        window(hdr.size - (tail - headCache));
+    }
+    // flush + signal end of input to reader
+    void Close() noexcept {
+        if (!LastError) publish();
+        hdr.writerClosed.store(true, std::memory_order_release);
+    }
+    ~RingOut() {
+        Close();
+    }
+private:
+    void publish() noexcept {
+        if (ptr) {
+            tail += ptr;
+            hdr.tail.store(tail, std::memory_order_release);
+            ptr = 0;
+        }
+    }
+    // nobody reads anymore: writes land in the (never published) rest of ring
+    void dropAll() noexcept {
+        LastError = EPIPE;
+        window(hdr.size);
+    }
+    // contiguous free space from tail up to wrap point
+    void window(uint64_t free) noexcept {
+        auto pos = tail & ring.mask;
+        auto contiguous = hdr.size - pos;
+        buffer = ring.data + pos;
+        ptr = 0;
+        capacity = size_t(free < contiguous ? free : contiguous);
+    }
+    SpscRing& ring;
+    SpscRing::Header& hdr;
+    uint64_t tail;
+    uint64_t headCache;
+};
+
+// Consumer side. Refill() waits only when nothing is left unread, otherwise it just
+// extends the window with committed bytes. LastError is EndOfInput after writer is closed
+// and everything was read
+struct RingIn final : In
+{
+    explicit RingIn(SpscRing& ring) : ring(ring), hdr(*ring.hdr) {
+        head = hdr.head.load(std::memory_order_relaxed);
+        tailCache = hdr.tail.load(std::memory_order_acquire);
+        window();
+    }
+    RingIn(const RingIn&) = delete;
+    void Refill(size_t) override {
+        release();
+        tailCache = hdr.tail.load(std::memory_order_acquire);
+        det::Backoff backoff;
+        while (tailCache == head) {
+            if (hdr.writerClosed.load(std::memory_order_acquire)) {
+                // writer might have committed right before closing
+                tailCache = hdr.tail.load(std::memory_order_acquire);
+                if (tailCache == head) {
+                    window();
+                    LastError = EndOfInput;
+                    return;
+                }
+                break;
+            }
+            backoff.Wait();
+            tailCache = hdr.tail.load(std::memory_order_acquire);
+        }
+        window();
+        LastError = 0;
+    }
+    // stop reading: writer gets EPIPE instead of waiting for space forever
+    void Close() noexcept {
+        release();
+        hdr.readerClosed.store(true, std::memory_order_release);
+    }
+    ~RingIn() {
+        Close();
+    }
+private:
+    // give consumed bytes back to writer, unread ones stay in window
+    void release() noexcept {
+        if (ptr) {
+            head += ptr;
+            hdr.head.store(head, std::memory_order_release);
+            window();
+        }
+    }
+    void window() noexcept {
+        auto pos = head & ring.mask;
+        auto avail = tailCache - head;
+        auto contiguous = hdr.size - pos;
+        buffer = ring.data + pos;
+        ptr = 0;
+        capacity = size_t(avail < contiguous ? avail : contiguous);
+    }
+    SpscRing& ring;
+    SpscRing::Header& hdr;
+    uint64_t head;
+    uint64_t tailCache;
+};
+
+} //membuff
+
+#endif //MEMBUFF_RING_HPP
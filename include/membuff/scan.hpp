@@ -0,0 +1,184 @@
+#ifndef MEMBUFF_SCAN_HPP
+#define MEMBUFF_SCAN_HPP
+
+#include <string>
+#include <cstdint>
+#include "membuff.hpp"
+
+#if defined(__SSE2__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace membuff
+{
+
+// Set of bytes: bitmap for scalar lookups + up to maxRanges [lo, hi] ranges,
+// that vector scan tests 16/32 bytes at once (more ranges => scalar only)
+struct CharClass {
+    static constexpr unsigned maxRanges = 8;
+
+    constexpr CharClass() noexcept = default;
+    constexpr CharClass(char c) noexcept {
+        Add(c);
+    }
+    constexpr CharClass(std::string_view chars) noexcept {
+        for (auto c: chars) Add(c);
+    }
+    constexpr CharClass(const char* chars) noexcept : CharClass(std::string_view(chars)) {}
+    constexpr CharClass& Add(char c) noexcept {
+        return Add(c, c);
+    }
+    // inclusive, unsigned order (inverted bounds are swapped)
+    constexpr CharClass& Add(char lo, char hi) noexcept {
+        if (uint8_t(lo) > uint8_t(hi)) {
+            auto t = lo; lo = hi; hi = t;
+        }
+        for (unsigned c = uint8_t(lo); c <= uint8_t(hi); ++c) {
+            bits[c >> 6] |= uint64_t(1) << (c & 63);
+        }
+        if (count < maxRanges) {
+            low[count] = uint8_t(lo);
+            span[count] = uint8_t(uint8_t(hi) - uint8_t(lo));
+        }
+        count++;
+        return *this;
+    }
+    constexpr bool Has(char c) const noexcept {
+        return bits[uint8_t(c) >> 6] >> (uint8_t(c) & 63) & 1;
+    }
+    constexpr bool Vectorizable() const noexcept {
+        return count && count <= maxRanges;
+    }
+    static constexpr CharClass Whitespace() noexcept {
+        return CharClass(" \t\r\n\v\f");
+    }
+    static constexpr CharClass Digit() noexcept {
+        return CharClass().Add('0', '9');
+    }
+
+    uint64_t bits[4] = {};
+    uint8_t low[maxRanges] = {};
+    uint8_t span[maxRanges] = {};
+    unsigned count = 0;
+};
+
+namespace det {
+
+// first byte in [p, end), for which cls.Has() == match (or end)
+template<bool match>
+const char* scan(const char* p, const char* end, const CharClass& cls) noexcept {
+    if (cls.Vectorizable()) {
+#ifdef __AVX2__
+        for (; end - p >= 32; p += 32) {
+            auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            auto hit = _mm256_setzero_si256();
+            for (unsigned i = 0; i < cls.count; ++i) {
+                // (x - lo) <= span as unsigned <=> lo <= x <= hi
+                auto d = _mm256_sub_epi8(x, _mm256_set1_epi8(char(cls.low[i])));
+                auto in = _mm256_cmpeq_epi8(_mm256_min_epu8(d, _mm256_set1_epi8(char(cls.span[i]))), d);
+                hit = _mm256_or_si256(hit, in);
+            }
+            auto mask = unsigned(_mm256_movemask_epi8(hit));
+            if (!match) mask = ~mask;
+            if (mask) return p + __builtin_ctz(mask);
+        }
+#endif
+#ifdef __SSE2__
+        for (; end - p >= 16; p += 16) {
+            auto x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            auto hit = _mm_setzero_si128();
+            for (unsigned i = 0; i < cls.count; ++i) {
+                auto d = _mm_sub_epi8(x, _mm_set1_epi8(char(cls.low[i])));
+                auto in = _mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(char(cls.span[i]))), d);
+                hit = _mm_or_si128(hit, in);
+            }
+            auto mask = unsigned(_mm_movemask_epi8(hit));
+            if (!match) mask = ~mask & 0xffff;
+            if (mask) return p + __builtin_ctz(mask);
+        }
+#endif
+    }
+    for (; p < end; ++p) {
+        if (cls.Has(*p) == match) return p;
+    }
+    return end;
+}
+
+} //det
+
+// position of first byte from set, or npos
+inline size_t FindAny(std::string_view data, const CharClass& set) noexcept {
+    auto end = data.data() + data.size();
+    auto found = det::scan<true>(data.data(), end, set);
+    return found == end ? std::string_view::npos : size_t(found - data.data());
+}
+
+// Offset (from ptr) of first byte from set, nothing is consumed => in.Borrow(result)
+// gives bytes before it. Refills, while backend can keep unread bytes contiguous.
+// npos if input ended or window is full before a match
+template<typename B>
+size_t FindAny(BasicIn<B>& in, const CharClass& set) {
+    in.LastError = 0;
+    size_t scanned = 0;
+    for (;;) {
+        auto start = in.buffer + in.ptr;
+        auto end = in.buffer + in.capacity;
+        auto found = det::scan<true>(start + scanned, end, set);
+        if (found != end) {
+            return size_t(found - start);
+        }
+        scanned = in.Available();
+        static_cast<B&>(in).Refill(scanned + 1);
+        if (in.LastError || in.Available() <= scanned) {
+            return std::string_view::npos;
+        }
+    }
+}
+
+// Appends bytes before delim to out and consumes delim.
+// false if input ended (or failed) first, out has the rest then
+template<typename B>
+bool ReadUntil(BasicIn<B>& in, char delim, std::string& out) {
+    const CharClass set(delim);
+    in.LastError = 0;
+    for (;;) {
+        auto start = in.buffer + in.ptr;
+        auto end = in.buffer + in.capacity;
+        auto found = det::scan<true>(start, end, set);
+        out.append(start, size_t(found - start));
+        if (found != end) {
+            in.ptr += size_t(found - start) + 1;
+            return true;
+        }
+        in.ptr = in.capacity;
+        static_cast<B&>(in).Refill(in.capacity);
+        if (meta_Unlikely(in.LastError || !in.Available())) {
+            return false;
+        }
+    }
+}
+
+// consumes bytes from set, returns how many
+template<typename B>
+size_t SkipWhile(BasicIn<B>& in, const CharClass& set) {
+    in.LastError = 0;
+    size_t skipped = 0;
+    for (;;) {
+        auto start = in.buffer + in.ptr;
+        auto end = in.buffer + in.capacity;
+        auto found = det::scan<false>(start, end, set);
+        skipped += size_t(found - start);
+        in.ptr += size_t(found - start);
+        if (found != end) {
+            return skipped;
+        }
+        static_cast<B&>(in).Refill(in.capacity);
+        if (meta_Unlikely(in.LastError || !in.Available())) {
+            return skipped;
+        }
+    }
+}
+
+} //membuff
+
+#endif //MEMBUFF_SCAN_HPP
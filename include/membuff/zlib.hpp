@@ -0,0 +1,145 @@
+#ifndef MEMBUFF_ZLIB_HPP
+#define MEMBUFF_ZLIB_HPP
+
+// Requires zlib (cmake -DUTILCPP_WITH_ZLIB=ON links it to utilcpp)
+
+#include <memory>
+#include <zlib.h>
+#include "codec.hpp"
+
+namespace membuff
+{
+
+// Deflate decorator: Grow() compresses own buffer straight into inner's window.
+// Inner errors are forwarded into LastError. Finish() (or destructor) writes stream trailer
+struct ZlibOut final : Out
+{
+    explicit ZlibOut(Out& inner, int level = Z_DEFAULT_COMPRESSION, bool gzip = false, size_t bufferSize = 65536) :
+        inner(inner), storage(new char[bufferSize])
+    {
+        buffer = storage.get();
+        capacity = bufferSize;
+        if (deflateInit2(&z, level, Z_DEFLATED, gzip ? 15 + 16 : 15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            throw std::bad_alloc();
+        }
+    }
+    ZlibOut(const ZlibOut&) = delete;
+    void Grow(size_t) override {
+        pump(Z_NO_FLUSH);
+    }
+    // everything written so far becomes decodable on the other side
+    void Flush() {
+        pump(Z_SYNC_FLUSH);
+    }
+    void Finish() {
+        if (!finished) {
+            pump(Z_FINISH);
+            finished = true;
+        }
+    }
+    ~ZlibOut() {
+        Finish();
+        deflateEnd(&z);
+    }
+private:
+    void pump(int mode) {
+        z.next_in = reinterpret_cast<Bytef*>(buffer);
+        z.avail_in = uInt(ptr);
+        ptr = 0;
+        LastError = 0;
+        for (;;) {
+            // ptr < capacity always holds for inner => avail_out > 0
+            z.next_out = reinterpret_cast<Bytef*>(inner.buffer + inner.ptr);
+            z.avail_out = uInt(inner.capacity - inner.ptr);
+            auto rc = deflate(&z, mode);
+            inner.ptr = size_t(reinterpret_cast<char*>(z.next_out) - inner.buffer);
+            if (meta_Unlikely(rc == Z_STREAM_ERROR)) {
+                LastError = BadEncoding;
+                return;
+            }
+            bool full = !z.avail_out;
+            if (full) {
+                inner.Grow(inner.capacity);
+                if (meta_Unlikely(inner.LastError)) {
+                    LastError = inner.LastError;
+                    return;
+                }
+            }
+            bool done = mode == Z_FINISH ? rc == Z_STREAM_END : !full && !z.avail_in;
+            if (done) {
+                return;
+            }
+        }
+    }
+    Out& inner;
+    std::unique_ptr<char[]> storage;
+    z_stream z = {};
+    bool finished = false;
+};
+
+// Inflate decorator (zlib or gzip, autodetected): Refill() decompresses from inner's window.
+// LastError is EndOfInput after stream end, BadEncoding on corrupt or truncated input
+struct ZlibIn final : In
+{
+    explicit ZlibIn(In& inner, size_t bufferSize = 65536) :
+        inner(inner), bufferSize(bufferSize), storage(new char[bufferSize])
+    {
+        buffer = storage.get();
+        if (inflateInit2(&z, 15 + 32) != Z_OK) {
+            throw std::bad_alloc();
+        }
+    }
+    ZlibIn(const ZlibIn&) = delete;
+    void Refill(size_t) override {
+        auto data = storage.get();
+        if (ptr) {
+            ::memmove(data, data + ptr, capacity - ptr);
+            capacity -= ptr;
+            ptr = 0;
+        }
+        LastError = 0;
+        auto before = capacity;
+        while (capacity == before && capacity < bufferSize) {
+            if (ended) {
+                LastError = EndOfInput;
+                return;
+            }
+            // inflate may still hold output, if it filled the buffer last time
+            if (!inner.Available() && !pending) {
+                inner.Refill(bufferSize);
+                if (meta_Unlikely(inner.LastError)) {
+                    LastError = inner.LastError == EndOfInput ? BadEncoding : inner.LastError;
+                    return;
+                }
+            }
+            z.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(inner.buffer + inner.ptr));
+            z.avail_in = uInt(inner.Available());
+            z.next_out = reinterpret_cast<Bytef*>(data + capacity);
+            z.avail_out = uInt(bufferSize - capacity);
+            auto rc = inflate(&z, Z_NO_FLUSH);
+            inner.ptr = size_t(reinterpret_cast<const char*>(z.next_in) - inner.buffer);
+            capacity = size_t(reinterpret_cast<char*>(z.next_out) - data);
+            pending = !z.avail_out;
+            if (rc == Z_STREAM_END) {
+                ended = true;
+            } else if (meta_Unlikely(rc != Z_OK && rc != Z_BUF_ERROR)) {
+                LastError = BadEncoding;
+                return;
+            }
+        }
+    }
+    ~ZlibIn() {
+        inflateEnd(&z);
+    }
+private:
+    In& inner;
+    size_t bufferSize;
+    std::unique_ptr<char[]> storage;
+    z_stream z = {};
+    bool pending = false;
+    bool ended = false;
+};
+
+} //membuff
+
+#endif //MEMBUFF_ZLIB_HPP
@@ -0,0 +1,140 @@
+#ifndef MEMBUFF_ZSTD_HPP
+#define MEMBUFF_ZSTD_HPP
+
+// Requires libzstd (cmake -DUTILCPP_WITH_ZSTD=ON links it to utilcpp)
+
+#include <memory>
+#include <zstd.h>
+#include "codec.hpp"
+
+namespace membuff
+{
+
+// Zstd frame decorator: Grow() compresses own buffer straight into inner's window.
+// Inner errors are forwarded into LastError. Finish() (or destructor) ends the frame
+struct ZstdOut final : Out
+{
+    explicit ZstdOut(Out& inner, int level = ZSTD_CLEVEL_DEFAULT, size_t bufferSize = ZSTD_CStreamInSize()) :
+        inner(inner), storage(new char[bufferSize]), cctx(ZSTD_createCCtx())
+    {
+        if (!cctx) {
+            throw std::bad_alloc();
+        }
+        buffer = storage.get();
+        capacity = bufferSize;
+        ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, level);
+    }
+    ZstdOut(const ZstdOut&) = delete;
+    void Grow(size_t) override {
+        pump(ZSTD_e_continue);
+    }
+    // everything written so far becomes decodable on the other side
+    void Flush() {
+        pump(ZSTD_e_flush);
+    }
+    void Finish() {
+        if (!finished) {
+            pump(ZSTD_e_end);
+            finished = true;
+        }
+    }
+    ~ZstdOut() {
+        Finish();
+        ZSTD_freeCCtx(cctx);
+    }
+private:
+    void pump(ZSTD_EndDirective mode) {
+        ZSTD_inBuffer in{buffer, ptr, 0};
+        ptr = 0;
+        LastError = 0;
+        for (;;) {
+            // ptr < capacity always holds for inner => out.size > 0
+            ZSTD_outBuffer out{inner.buffer + inner.ptr, inner.capacity - inner.ptr, 0};
+            auto left = ZSTD_compressStream2(cctx, &out, &in, mode);
+            inner.ptr += out.pos;
+            if (meta_Unlikely(ZSTD_isError(left))) {
+                LastError = BadEncoding;
+                return;
+            }
+            if (out.pos == out.size) {
+                inner.Grow(inner.capacity);
+                if (meta_Unlikely(inner.LastError)) {
+                    LastError = inner.LastError;
+                    return;
+                }
+            }
+            bool done = mode == ZSTD_e_continue ? in.pos == in.size : !left;
+            if (done) {
+                return;
+            }
+        }
+    }
+    Out& inner;
+    std::unique_ptr<char[]> storage;
+    ZSTD_CCtx* cctx;
+    bool finished = false;
+};
+
+// Zstd decorator (concatenated frames are read as one stream): Refill() decompresses from inner's window.
+// LastError is EndOfInput after last complete frame, BadEncoding on corrupt or truncated input
+struct ZstdIn final : In
+{
+    explicit ZstdIn(In& inner, size_t bufferSize = ZSTD_DStreamOutSize()) :
+        inner(inner), bufferSize(bufferSize), storage(new char[bufferSize]), dctx(ZSTD_createDCtx())
+    {
+        if (!dctx) {
+            throw std::bad_alloc();
+        }
+        buffer = storage.get();
+    }
+    ZstdIn(const ZstdIn&) = delete;
+    void Refill(size_t) override {
+        auto data = storage.get();
+        if (ptr) {
+            ::memmove(data, data + ptr, capacity - ptr);
+            capacity -= ptr;
+            ptr = 0;
+        }
+        LastError = 0;
+        auto before = capacity;
+        while (capacity == before && capacity < bufferSize) {
+            // decoder may still hold output, if it filled the buffer last time
+            if (!inner.Available() && !pending) {
+                inner.Refill(bufferSize);
+                if (meta_Unlikely(inner.LastError)) {
+                    bool clean = inner.LastError == EndOfInput && frameDone;
+                    LastError = clean ? EndOfInput : inner.LastError == EndOfInput ? BadEncoding : inner.LastError;
+                    return;
+                }
+            }
+            ZSTD_inBuffer in{inner.buffer + inner.ptr, inner.Available(), 0};
+            ZSTD_outBuffer out{data + capacity, bufferSize - capacity, 0};
+            auto hint = ZSTD_decompressStream(dctx, &out, &in);
+            inner.ptr += in.pos;
+            capacity += out.pos;
+            if (meta_Unlikely(ZSTD_isError(hint))) {
+                LastError = BadEncoding;
+                return;
+            }
+            pending = out.pos == out.size;
+            // idle call after a frame end returns hint for the next one
+            if (in.pos || out.pos) {
+                frameDone = !hint;
+            }
+        }
+    }
+    ~ZstdIn() {
+        ZSTD_freeDCtx(dctx);
+    }
+private:
+    In& inner;
+    size_t bufferSize;
+    std::unique_ptr<char[]> storage;
+    ZSTD_DCtx* dctx;
+    bool pending = false;
+    bool frameDone = true;
+};
+
+} //membuff
+
+#endif //MEMBUFF_ZSTD_HPP
@@ -0,0 +1,15 @@
+#ifndef UTILCPP_TESTS_CHECK_HPP
+#define UTILCPP_TESTS_CHECK_HPP
+
+#include <cstdio>
+#include <cstdlib>
+
+// works with NDEBUG too (unlike assert)
+#define CHECK(...) do { \
+    if (!(__VA_ARGS__)) { \
+        std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #__VA_ARGS__); \
+        std::abort(); \
+    } \
+} while (0)
+
+#endif //UTILCPP_TESTS_CHECK_HPP
@@ -0,0 +1,72 @@
+#include <thread>
+#include <cstdint>
+#include "future/future.hpp"
+#include "check.hpp"
+
+using namespace fut;
+
+static bool aligned(void* p, size_t align) {
+    return reinterpret_cast<uintptr_t>(p) % align == 0;
+}
+
+static void blockReuse() {
+    using Pool = BlockPool<40>;
+    auto a = Pool::Allocate();
+    Pool::Deallocate(a);
+    CHECK(Pool::Allocate() == a); // per-thread free list is LIFO
+    Pool::Deallocate(a);
+    using Big = BlockPool<64, 64>;
+    auto b = Big::Allocate();
+    CHECK(aligned(b, 64));
+    // freed on another thread => migrates to its list
+    std::thread([b]{Big::Deallocate(b);}).join();
+}
+
+// block freed by a thread_local, that is destroyed after the pool's list
+struct LateFree {
+    void* block = nullptr;
+    ~LateFree() {
+        if (block) BlockPool<24>::Deallocate(block);
+    }
+};
+
+static void freeAtThreadExit() {
+    std::thread([]{
+        static thread_local LateFree late;
+        late.block = BlockPool<24>::Allocate();
+    }).join();
+}
+
+static void arenaAlignment() {
+    Arena arena(256);
+    for (int i = 0; i < 64; ++i) {
+        arena.Allocate(3, 1);
+        CHECK(aligned(arena.Allocate(40, 64), 64));
+        CHECK(aligned(arena.Allocate(8, 256), 256));
+    }
+}
+
+static void arenaScope() {
+    Arena arena;
+    CHECK(!Arena::Current());
+    {
+        ArenaScope scope(arena);
+        CHECK(Arena::Current() == &arena);
+        Promise<int> prom;
+        int got = 0;
+        prom.GetFuture().Then([&](FutureResult<int> res) {got = *res.Result();});
+        CHECK(prom.PeekState()->Has(FutureStateData<int>::from_arena));
+        prom.Resolve(3);
+        CHECK(got == 3);
+    }
+    CHECK(!Arena::Current());
+    Promise<int> prom;
+    CHECK(!prom.PeekState()->Has(FutureStateData<int>::from_arena));
+}
+
+int main() {
+    blockReuse();
+    freeAtThreadExit();
+    arenaAlignment();
+    arenaScope();
+}
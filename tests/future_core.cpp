@@ -0,0 +1,63 @@
+#include <memory>
+#include "future/future.hpp"
+#include "check.hpp"
+
+using namespace fut;
+
+using Ptr = std::shared_ptr<int>;
+
+static bool isTimeout(FutureResult<int>& res) {
+    try {
+        res.Rethrow();
+    } catch (TimeoutError&) {
+        return true;
+    } catch (...) {}
+    return false;
+}
+
+// rejected callback owns chained promise, whose cancel hook owns upstream state
+static void falseGuardLateResolve() {
+    std::weak_ptr<int> weak;
+    bool timedOut = false;
+    {
+        Promise<Ptr> prom;
+        auto chained = prom.GetFuture().ThenIf([]{return false;}, [](Ptr p) {
+            return *p;
+        });
+        std::move(chained).Then([&](FutureResult<int> res) {
+            timedOut = isTimeout(res);
+        });
+        auto value = std::make_shared<int>(1);
+        weak = value;
+        prom.Resolve(std::move(value));
+    }
+    CHECK(timedOut);
+    CHECK(weak.expired()); // upstream state (holding value) is freed
+}
+
+// subscription must not outlive resolved future on a long-lived token
+static void cancelOnReleased() {
+    CancellationSource source;
+    std::weak_ptr<int> weak;
+    {
+        Promise<Ptr> prom;
+        auto fut = prom.GetFuture();
+        fut.CancelOn(source.Token());
+        auto value = std::make_shared<int>(1);
+        weak = value;
+        prom.Resolve(std::move(value));
+    }
+    CHECK(weak.expired());
+    bool cancelled = false;
+    Promise<int> prom;
+    prom.OnCancel([&]{cancelled = true;});
+    auto fut = prom.GetFuture();
+    fut.CancelOn(source.Token());
+    source.Cancel();
+    CHECK(cancelled);
+}
+
+int main() {
+    falseGuardLateResolve();
+    cancelOnReleased();
+}
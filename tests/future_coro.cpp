@@ -0,0 +1,82 @@
+#include <memory>
+#include <stdexcept>
+#include "future/coro.hpp"
+#include "check.hpp"
+
+using namespace fut;
+
+static Future<int> addOne(Future<int> fut) {
+    co_return co_await std::move(fut) + 1;
+}
+
+static Future<int> chain(Future<int> fut) {
+    auto a = co_await addOne(std::move(fut));
+    auto b = co_await addOne(FutureFromResult(a));
+    co_return b;
+}
+
+// TimeoutError of cancelled producer becomes -1
+static Future<int> orFallback(Future<int> fut) {
+    try {
+        co_return co_await std::move(fut);
+    } catch (TimeoutError&) {
+        co_return -1;
+    }
+}
+
+static int result(Future<int> fut) {
+    CHECK(fut.IsReady());
+    int res = 0;
+    std::move(fut).Then([&](FutureResult<int> r) {
+        CHECK(r);
+        res = *r.Result();
+    });
+    return res;
+}
+
+static void ready() {
+    CHECK(result(chain(FutureFromResult(1))) == 3);
+}
+
+static void lateResolve() {
+    Promise<int> prom;
+    auto fut = chain(prom.GetFuture());
+    CHECK(!fut.IsReady());
+    prom.Resolve(10);
+    CHECK(result(std::move(fut)) == 12);
+}
+
+static void exception() {
+    Promise<int> prom;
+    auto fut = chain(prom.GetFuture());
+    prom.Resolve(std::make_exception_ptr(std::runtime_error("boom")));
+    CHECK(fut.IsReady());
+    bool caught = false;
+    std::move(fut).Then([&](FutureResult<int> res) {
+        try {
+            res.Rethrow();
+        } catch (std::runtime_error&) {
+            caught = true;
+        }
+    });
+    CHECK(caught);
+}
+
+static void cancel() {
+    CancellationSource source;
+    auto prom = std::make_unique<Promise<int>>();
+    prom->OnCancel([&]{prom.reset();}); // dropped promise => TimeoutError
+    auto upstream = prom->GetFuture();
+    upstream.CancelOn(source.Token());
+    auto fut = orFallback(std::move(upstream));
+    CHECK(!fut.IsReady());
+    source.Cancel();
+    CHECK(result(std::move(fut)) == -1);
+}
+
+int main() {
+    ready();
+    lateResolve();
+    exception();
+    cancel();
+}
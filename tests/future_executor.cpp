@@ -0,0 +1,81 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "future/future.hpp"
+#include "future/executor.hpp"
+#include "check.hpp"
+
+using namespace fut;
+
+// continuation runs only when executor gets to it
+static void viaManual() {
+    ManualExecutor ex;
+    Promise<int> prom;
+    int got = 0;
+    (void)prom.GetFuture().Then(ex, [&](int v) {got = v;});
+    prom.Resolve(5);
+    CHECK(got == 0);
+    CHECK(ex.Pending() == 1);
+    CHECK(ex.Drain() == 1);
+    CHECK(got == 5);
+    // ready future is posted as well
+    (void)FutureFromResult(7).Then(ex, [&](int v) {got = v;});
+    CHECK(got == 5);
+    ex.Drain();
+    CHECK(got == 7);
+}
+
+static void viaInline() {
+    InlineExecutor ex;
+    Executor& erased = ex;
+    int got = 0;
+    (void)FutureFromResult(3).Via(erased).Then([&](int v) {got = v;});
+    CHECK(got == 3);
+}
+
+static void thenIf() {
+    bool ran = false;
+    Promise<int> prom;
+    (void)prom.GetFuture().ThenIf([]{return true;}, [&](int) {ran = true;});
+    prom.Resolve(1);
+    CHECK(ran);
+    ran = false;
+    bool timedOut = false;
+    auto skipped = FutureFromResult(1).ThenIf([]{return false;}, [&](int v) {
+        ran = true;
+        return v;
+    });
+    std::move(skipped).Then([&](FutureResult<int> res) {
+        try {
+            res.Rethrow();
+        } catch (TimeoutError&) {
+            timedOut = true;
+        } catch (...) {}
+    });
+    CHECK(!ran);
+    CHECK(timedOut);
+}
+
+// Resolve() and Then() race from different threads: callback runs exactly once
+static void handoffRace() {
+    constexpr int rounds = 2000;
+    std::atomic<int> calls = 0;
+    for (int i = 0; i < rounds; ++i) {
+        Promise<int> prom;
+        auto fut = prom.GetFuture();
+        std::thread producer([&]{prom.Resolve(i);});
+        (void)fut.Then([&, i](int v) {
+            CHECK(v == i);
+            calls.fetch_add(1, std::memory_order_relaxed);
+        });
+        producer.join();
+    }
+    CHECK(calls.load() == rounds);
+}
+
+int main() {
+    viaManual();
+    viaInline();
+    thenIf();
+    handoffRace();
+}
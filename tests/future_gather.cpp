@@ -0,0 +1,144 @@
+#include <string>
+#include <thread>
+#include <future>
+#include <vector>
+#include <variant>
+#include <stdexcept>
+#include "future/gather.hpp"
+#include "check.hpp"
+
+using namespace fut;
+
+// first success wins, the rest get Cancel()-ed
+static void anyCancelsLosers() {
+    Promise<int> a;
+    Promise<std::string> b;
+    bool aCancelled = false, bCancelled = false;
+    a.OnCancel([&]{aCancelled = true;});
+    b.OnCancel([&]{bCancelled = true;});
+    auto first = WhenAny(a.GetFuture(), b.GetFuture());
+    CHECK(!first.IsReady());
+    b.Resolve(std::string("b"));
+    CHECK(aCancelled);
+    CHECK(!bCancelled);
+    a.Resolve(1); // loser resolving late is ignored
+    std::optional<std::variant<int, std::string>> got;
+    std::move(first).Then([&](FutureResult<std::variant<int, std::string>> res) {got = *res.Result();});
+    CHECK(got && got->index() == 1 && std::get<1>(*got) == "b");
+}
+
+static void anyVector() {
+    std::vector<Promise<int>> proms(3);
+    std::vector<Future<int>> futs;
+    int cancelled = 0;
+    for (auto& p: proms) {
+        p.OnCancel([&]{cancelled++;});
+        futs.push_back(p.GetFuture());
+    }
+    auto first = WhenAny(std::move(futs));
+    proms[0].Resolve(std::make_exception_ptr(std::runtime_error("fail"))); // failures wait for others
+    CHECK(!first.IsReady());
+    proms[2].Resolve(7);
+    CHECK(cancelled == 1); // only still pending loser
+    std::pair<size_t, int> got;
+    std::move(first).Then([&](FutureResult<std::pair<size_t, int>> res) {got = *res.Result();});
+    CHECK(got.first == 2 && got.second == 7);
+    proms[1].Resolve(0);
+}
+
+static void anyAllFail() {
+    Promise<int> a, b;
+    auto first = WhenAny(a.GetFuture(), b.GetFuture());
+    a.Resolve(std::make_exception_ptr(std::runtime_error("a")));
+    CHECK(!first.IsReady());
+    b.Resolve(std::make_exception_ptr(std::logic_error("b")));
+    bool last = false;
+    std::move(first).Then([&](FutureResult<std::variant<int, int>> res) {
+        try {
+            res.Rethrow();
+        } catch (std::logic_error&) {
+            last = true;
+        } catch (...) {}
+    });
+    CHECK(last);
+}
+
+template<typename T>
+static std::vector<T> gathered(Future<std::vector<T>> fut) {
+    CHECK(fut.IsReady());
+    std::vector<T> res;
+    std::move(fut).Then([&](FutureResult<std::vector<T>> r) {res = std::move(*r.Result());});
+    return res;
+}
+
+struct NoDefault {
+    explicit NoDefault(int v) : v(v) {}
+    int v;
+};
+
+// results keep input order, whatever order futures resolve in
+static void gatherOrder() {
+    std::vector<Promise<int>> proms(4);
+    std::vector<Future<int>> futs;
+    for (auto& p: proms) futs.push_back(p.GetFuture());
+    auto all = Gather(std::move(futs));
+    for (int i: {2, 0, 3, 1}) {
+        CHECK(!all.IsReady());
+        proms[size_t(i)].Resolve(i * 10);
+    }
+    CHECK((gathered(std::move(all)) == std::vector<int>{0, 10, 20, 30}));
+    std::vector<Future<NoDefault>> nd;
+    nd.push_back(FutureFromResult(NoDefault(1)));
+    nd.push_back(FutureFromResult(NoDefault(2)));
+    auto res = gathered(Gather(std::move(nd)));
+    CHECK(res.size() == 2 && res[0].v == 1 && res[1].v == 2);
+    CHECK(gathered(Gather(std::vector<Future<int>>{})).empty());
+}
+
+// vector<bool> results are written from different threads
+static void gatherThreads() {
+    constexpr size_t count = 64;
+    std::vector<Promise<bool>> proms(count);
+    std::vector<Future<bool>> futs;
+    for (auto& p: proms) futs.push_back(p.GetFuture());
+    auto all = ToStdFuture(Gather(std::move(futs)));
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t]{
+            for (size_t i = t; i < count; i += 4) proms[i].Resolve(i % 3 == 0);
+        });
+    }
+    for (auto& t: threads) t.join();
+    auto res = all.get();
+    CHECK(res.size() == count);
+    for (size_t i = 0; i < count; ++i) CHECK(res[i] == (i % 3 == 0));
+}
+
+static void gatherError() {
+    std::vector<Promise<void>> proms(3);
+    std::vector<Future<void>> futs;
+    for (auto& p: proms) futs.push_back(p.GetFuture());
+    auto all = Gather(std::move(futs));
+    proms[1].Resolve(std::make_exception_ptr(std::runtime_error("first")));
+    CHECK(all.IsReady()); // does not wait for the rest
+    proms[0].Resolve(std::make_exception_ptr(std::logic_error("second")));
+    proms[2].Resolve();
+    bool first = false;
+    std::move(all).Then([&](FutureResult<void> res) {
+        try {
+            res.Rethrow();
+        } catch (std::runtime_error&) {
+            first = true;
+        } catch (...) {}
+    });
+    CHECK(first);
+}
+
+int main() {
+    anyCancelsLosers();
+    anyVector();
+    anyAllFail();
+    gatherOrder();
+    gatherThreads();
+    gatherError();
+}
@@ -0,0 +1,91 @@
+#include <array>
+#include <memory>
+#include "future/move_func.hpp"
+#include "check.hpp"
+
+using namespace fut;
+
+// counts live copies => every capture is destroyed exactly once
+struct Tracked {
+    explicit Tracked(int* live) : live(live) {++*live;}
+    Tracked(const Tracked& o) : live(o.live) {++*live;}
+    Tracked(Tracked&& o) noexcept : live(o.live) {++*live;}
+    ~Tracked() {--*live;}
+    int* live;
+};
+
+static int twice(int x) {return x * 2;}
+static int twiceNothrow(int x) noexcept {return x * 2;}
+
+static void moveFunc() {
+    int live = 0;
+    {
+        // small (inline) and big (spilled) captures, move-only one
+        std::array<char, 128> big {};
+        big[0] = 3;
+        MoveFunc<int(int)> small = [t = Tracked(&live), p = std::make_unique<int>(1)](int x) {return x + *p;};
+        MoveFunc<int(int)> spilled = [t = Tracked(&live), big](int x) {return x + big[0];};
+        CHECK(live == 2);
+        CHECK(small(1) == 2);
+        CHECK(spilled(1) == 4);
+        auto moved = std::move(spilled);
+        CHECK(!spilled);
+        CHECK(moved(2) == 5);
+        small = std::move(moved);
+        CHECK(live == 1);
+        CHECK(small(0) == 3);
+        bool thrown = false;
+        try {
+            moved(0);
+        } catch (InvalidMoveFuncCall&) {
+            thrown = true;
+        }
+        CHECK(thrown);
+    }
+    CHECK(live == 0);
+    // capture bigger than custom inline size => spills into custom allocator
+    int base = 10;
+    MoveFunc<int(int) noexcept, sizeof(void*), call::NewAlloc> tiny = [base, x = 1.0](int v) noexcept {
+        return base + v + int(x);
+    };
+    CHECK(tiny(1) == 12);
+}
+
+static void function() {
+    int live = 0;
+    {
+        Function<int()> a = [t = Tracked(&live), n = 5]{return n;};
+        auto b = a;
+        CHECK(live == 2);
+        CHECK(a() == 5 && b() == 5);
+        a = Function<int()>([]{return 1;});
+        CHECK(live == 1);
+        CHECK(a() == 1);
+    }
+    CHECK(live == 0);
+}
+
+static int callRef(FunctionRef<int(int)> f) {
+    return f(21);
+}
+
+static void functionRef() {
+    int calls = 0;
+    auto lambda = [&](int x) {calls++; return x;};
+    CHECK(callRef(lambda) == 21);
+    CHECK(callRef(twice) == 42);
+    CHECK(calls == 1);
+    // prvalue function pointer is stored by value
+    FunctionRef<int(int)> ptr = &twice;
+    CHECK(ptr(4) == 8);
+    FunctionRef<int(int) noexcept> nothrow = &twiceNothrow;
+    CHECK(nothrow(5) == 10);
+    static_assert(!std::is_constructible_v<FunctionRef<int(int) noexcept>, int(*)(int)>);
+    static_assert(!std::is_constructible_v<FunctionRef<int(int) noexcept>, decltype(lambda)&>);
+}
+
+int main() {
+    moveFunc();
+    function();
+    functionRef();
+}
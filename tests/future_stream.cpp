@@ -0,0 +1,55 @@
+#include <array>
+#include <memory>
+#include <future>
+#include "future/stream.hpp"
+#include "check.hpp"
+
+using namespace fut;
+
+// callback stops its own stream: callable (big capture => heap) must outlive the call
+static void stopFromCallback() {
+    Channel<int> ch(4);
+    auto stream = std::make_shared<Stream<int>>(ch.GetStream());
+    auto alive = std::make_shared<int>(0);
+    std::array<char, 512> big {};
+    int seen = 0;
+    auto done = ToStdFuture(stream->OnBatch([stream, alive, big, &seen](Batch<int> batch) {
+        seen += int(batch.size()) + big[0];
+        stream->Stop();
+        CHECK(*alive == 0); // captures are still valid after Stop()
+        *alive = 1;
+    }));
+    std::weak_ptr<int> weakAlive = alive;
+    alive.reset();
+    ToStdFuture(ch.Send(1)).get();
+    done.get();
+    CHECK(seen == 1);
+    CHECK(weakAlive.expired()); // callback released once drain returned
+    bool closed = false;
+    try {
+        ToStdFuture(ch.Send(2)).get();
+    } catch (ChannelClosed&) {
+        closed = true;
+    }
+    CHECK(closed);
+}
+
+static void orderAndClose() {
+    Channel<int> ch(2);
+    auto stream = ch.GetStream();
+    auto a = ch.Send(0), b = ch.Send(1), c = ch.Send(2); // c waits for room
+    CHECK(!c.IsReady());
+    std::vector<int> got;
+    auto done = ToStdFuture(stream.OnBatch([&](Batch<int> batch) {
+        for (auto v: batch) got.push_back(v);
+    }));
+    ToStdFuture(std::move(c)).get();
+    ch.Close();
+    done.get();
+    CHECK((got == std::vector<int>{0, 1, 2}));
+}
+
+int main() {
+    stopFromCallback();
+    orderAndClose();
+}
@@ -0,0 +1,63 @@
+#include <atomic>
+#include <future>
+#include <stdexcept>
+#include "future/thread_pool.hpp"
+#include "check.hpp"
+
+using namespace fut;
+
+static void asyncResults() {
+    WorkStealingPool pool(2);
+    CHECK(pool.Size() == 2);
+    CHECK(ToStdFuture(Async(pool, []{return 42;})).get() == 42);
+    // future returned from fn is flattened
+    auto nested = Async(pool, [&]{return Async(pool, []{return 1;});});
+    CHECK(ToStdFuture(std::move(nested)).get() == 1);
+    bool thrown = false;
+    try {
+        ToStdFuture(Async(pool, []() -> int {throw std::runtime_error("boom");})).get();
+    } catch (std::runtime_error&) {
+        thrown = true;
+    }
+    CHECK(thrown);
+}
+
+// tasks spawned from workers go to local deques and get stolen, all of them run
+static void spawnFromWorkers() {
+    std::atomic<int> count = 0;
+    {
+        WorkStealingPool pool(4);
+        struct Spawn {
+            WorkStealingPool* pool;
+            std::atomic<int>* count;
+            int depth;
+            void operator()() const {
+                count->fetch_add(1, std::memory_order_relaxed);
+                if (!depth) return;
+                pool->Execute(Spawn{pool, count, depth - 1});
+                pool->Execute(Spawn{pool, count, depth - 1});
+            }
+        };
+        for (int i = 0; i < 4; ++i) {
+            pool.Execute(Spawn{&pool, &count, 10});
+        }
+    } // destructor runs everything queued
+    CHECK(count.load() == 4 * ((1 << 11) - 1));
+}
+
+static void drainOnDestruction() {
+    std::atomic<int> count = 0;
+    {
+        ThreadPoolExecutor pool(1);
+        for (int i = 0; i < 1000; ++i) {
+            pool.Execute([&]{count.fetch_add(1, std::memory_order_relaxed);});
+        }
+    }
+    CHECK(count.load() == 1000);
+}
+
+int main() {
+    asyncResults();
+    spawnFromWorkers();
+    drainOnDestruction();
+}
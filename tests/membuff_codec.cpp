@@ -0,0 +1,53 @@
+#include <cstdint>
+#include <string>
+#include "membuff/codec.hpp"
+#include "check.hpp"
+
+using namespace membuff;
+
+// exposes source one byte per Refill() => forces slow (byte-by-byte) paths
+struct TrickleIn final : In {
+    explicit TrickleIn(std::string_view src, bool trickle) : trickle(trickle) {
+        buffer = src.data();
+        total = src.size();
+        capacity = trickle ? 0 : total;
+    }
+    void Refill(size_t) override {
+        if (capacity == total) LastError = EndOfInput;
+        else capacity++;
+    }
+    size_t total;
+    bool trickle;
+};
+
+static void varintMax(bool trickle) {
+    StringOut<> out;
+    WriteVarint(out, UINT64_MAX);
+    WriteVarint(out, 0);
+    auto data = out.Consume();
+    CHECK(data.size() == MaxVarintSize + 1);
+    TrickleIn in(data, trickle);
+    uint64_t v = 0;
+    CHECK(ReadVarint(in, v));
+    CHECK(v == UINT64_MAX);
+    CHECK(ReadVarint(in, v));
+    CHECK(v == 0);
+}
+
+// 10th byte may only carry the top bit of a 64-bit value
+static void varintOverflow(bool trickle) {
+    std::string data(9, char(0xff));
+    data += char(0x02);
+    data += std::string(MaxVarintSize, '\0');
+    TrickleIn in(data, trickle);
+    uint64_t v = 0;
+    CHECK(!ReadVarint(in, v));
+    CHECK(in.LastError == BadEncoding);
+}
+
+int main() {
+    for (bool trickle: {false, true}) {
+        varintMax(trickle);
+        varintOverflow(trickle);
+    }
+}
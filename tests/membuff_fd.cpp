@@ -0,0 +1,42 @@
+#include <unistd.h>
+#include "membuff/fd.hpp"
+#include "check.hpp"
+
+using namespace membuff;
+
+// reading exactly the buffered bytes must not block in Refill(), writer is still open
+static void readBufferedExactly() {
+    int fds[2];
+    CHECK(::pipe(fds) == 0);
+    CHECK(::write(fds[1], "abcdefgh", 8) == 8);
+    FdIn in(fds[0], 64);
+    char buf[4];
+    CHECK(in.Read(buf, 4) == 4);
+    CHECK(in.Read(buf, 4) == 4);
+    CHECK(std::string_view(buf, 4) == "efgh");
+    CHECK(in.Available() == 0);
+    ::close(fds[1]);
+    CHECK(in.Read(buf, 1) == 0);
+    CHECK(in.LastError == Common::EndOfInput);
+    ::close(fds[0]);
+}
+
+// read spanning buffered and fresh bytes, tail after end of input
+static void readAcrossRefill() {
+    int fds[2];
+    CHECK(::pipe(fds) == 0);
+    CHECK(::write(fds[1], "0123456789", 10) == 10);
+    ::close(fds[1]);
+    FdIn in(fds[0], 4);
+    char buf[16];
+    CHECK(in.Read(buf, 2) == 2);
+    CHECK(in.Read(buf, 16) == 8);
+    CHECK(std::string_view(buf, 8) == "23456789");
+    CHECK(in.LastError == Common::EndOfInput);
+    ::close(fds[0]);
+}
+
+int main() {
+    readBufferedExactly();
+    readAcrossRefill();
+}
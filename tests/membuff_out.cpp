@@ -0,0 +1,52 @@
+#include <cerrno>
+#include <string>
+#include "membuff/membuff.hpp"
+#include "check.hpp"
+
+using namespace membuff;
+
+// fixed window, Grow() always fails
+struct FixedOut final : Out {
+    FixedOut() {
+        buffer = storage;
+        capacity = sizeof(storage);
+    }
+    void Grow(size_t) override {
+        grows++;
+        LastError = ENOSPC;
+    }
+    char storage[8];
+    int grows = 0;
+};
+
+// window is filled before Grow(), ptr < capacity after every Write()
+static void writeAcrossCapacity() {
+    StringOut<> out(16);
+    std::string expected(10, 'a');
+    out.Write(expected);
+    std::string big(100, 'b');
+    out.Write(big);
+    expected += big;
+    CHECK(out.ptr < out.capacity);
+    std::string exact(out.capacity - out.ptr, 'c');
+    out.Write(exact); // fills window exactly => grows right away
+    expected += exact;
+    CHECK(out.ptr < out.capacity);
+    out.Write('!');
+    expected += '!';
+    CHECK(out.Consume() == expected);
+}
+
+static void failingGrow() {
+    FixedOut out;
+    out.Write("0123456789abcdef", 16);
+    CHECK(out.LastError == ENOSPC);
+    CHECK(out.grows == 1);
+    CHECK(out.ptr == out.capacity);
+    CHECK(std::string(out.storage, sizeof(out.storage)) == "01234567");
+}
+
+int main() {
+    writeAcrossCapacity();
+    failingGrow();
+}
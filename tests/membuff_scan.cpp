@@ -0,0 +1,32 @@
+#include <string>
+#include "membuff/scan.hpp"
+#include "check.hpp"
+
+using namespace membuff;
+
+// vector and scalar paths must agree: long input hits the vector loop, short one scalar only
+static void agree(const CharClass& cls) {
+    std::string all;
+    for (int rep = 0; rep < 2; ++rep) {
+        for (unsigned c = 0; c < 256; ++c) all += char(c);
+    }
+    for (size_t from = 0; from < all.size(); ++from) {
+        std::string_view view(all.data() + from, all.size() - from);
+        auto expected = std::string_view::npos;
+        for (size_t i = 0; i < view.size(); ++i) {
+            if (cls.Has(view[i])) {expected = i; break;}
+        }
+        CHECK(FindAny(view, cls) == expected);
+    }
+}
+
+int main() {
+    auto inverted = CharClass().Add('z', 'a');
+    auto normal = CharClass().Add('a', 'z');
+    for (unsigned c = 0; c < 256; ++c) {
+        CHECK(inverted.Has(char(c)) == normal.Has(char(c)));
+    }
+    agree(inverted);
+    agree(CharClass().Add(char(0xf0), char(0x10)));
+    agree(CharClass::Whitespace());
+}